@@ -25,6 +25,9 @@
 
 #define MAX_CUSTOM_SHADERS 2048 // Maximum number of linkable custom shaders
 #define MAX_CUSTOM_PROGRAMS 1024 // Maximum number of linkable custom programs
+#define CUSTOM_SHADER_CACHE_MAGIC 0 // This must be increased whenever the bundled vitaShaRK output changes
+#define PROGRAM_BINARY_MAGIC 0x50474C56 // 'VGLP' magic for glGetProgramBinary blobs
+#define PROGRAM_BINARY_VERSION 1 // This must be increased whenever the glGetProgramBinary blobs layout changes
 
 #define DISABLED_ATTRIBS_POOL_SIZE (256 * 1024) // Disabled attributes circular pool size in bytes
 
@@ -72,8 +75,26 @@ typedef struct uniform {
 	uint32_t size;
 	GLboolean is_fragment;
 	GLboolean is_vertex;
+	void *shadow; // Default uniform buffer image of the program stage the uniform belongs to
+	void *alias; // Fragment uniform sharing data with this vertex uniform
 } uniform;
 
+// Program parameters hash table entry struct
+typedef struct param_entry {
+	const char *name;
+	const SceGxmProgramParameter *param;
+	uniform *u;
+	uint32_t hash;
+} param_entry;
+
+// Uniform block struct
+typedef struct uniform_block {
+	const char *name;
+	int8_t vert_idx;
+	int8_t frag_idx;
+	uint8_t binding;
+} uniform_block;
+
 // Generic shader struct
 typedef struct shader {
 	GLenum type;
@@ -111,14 +132,51 @@ typedef struct program {
 	const SceGxmProgramParameter *wvp;
 	uniform *vert_uniforms;
 	uniform *frag_uniforms;
+	void *vert_unifs_shadow;
+	void *frag_unifs_shadow;
+	uint32_t vert_unifs_size;
+	uint32_t frag_unifs_size;
+	param_entry *params;
+	uint32_t params_mask;
+	uniform_block blocks[UNIFORM_BUFFERS_NUM];
+	uint8_t blocks_num;
 	GLuint attr_highest_idx;
 	GLboolean has_unaligned_attrs;
+	GLuint binary_shaders[2];
 } program;
 
+// Program binary header as produced by glGetProgramBinary (followed by vertex and fragment gxp blobs)
+typedef struct program_binary_header {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t vert_size;
+	uint32_t frag_size;
+	uint32_t stream_num;
+	uint32_t attr_highest_idx;
+	SceGxmVertexAttribute attr[VERTEX_ATTRIBS_NUM];
+	SceGxmVertexStream stream[VERTEX_ATTRIBS_NUM];
+} program_binary_header;
+
 // Internal shaders and array
 static shader shaders[MAX_CUSTOM_SHADERS];
 static program progs[MAX_CUSTOM_PROGRAMS];
 
+static void setup_uniform_buffers(program *p) {
+	// Binding buffers set through glUniformBlockBinding to the program uniform buffers
+	for (int i = 0; i < p->blocks_num; i++) {
+		uniform_block *b = &p->blocks[i];
+		gpubuffer *gpu_buf = (gpubuffer *)uniform_buffer_bindings[b->binding].buffer;
+		if (gpu_buf) {
+			uint8_t *ptr = (uint8_t *)gpu_buf->ptr + uniform_buffer_bindings[b->binding].offset;
+			gpu_buf->used = GL_TRUE;
+			if (b->vert_idx >= 0)
+				sceGxmSetVertexUniformBuffer(gxm_context, b->vert_idx, ptr);
+			if (b->frag_idx >= 0)
+				sceGxmSetFragmentUniformBuffer(gxm_context, b->frag_idx, ptr);
+		}
+	}
+}
+
 float *reserve_attrib_pool(uint8_t count) {
 	float *res = vertex_attrib_pool_ptr;
 	vertex_attrib_pool_ptr += count;
@@ -240,7 +298,7 @@ void resetCustomShaders(void) {
 	}
 }
 
-GLboolean _glDrawArrays_CustomShadersIMPL(GLsizei count) {
+GLboolean _glDrawArrays_CustomShadersIMPL(GLsizei count, GLsizei instances) {
 	program *p = &progs[cur_program - 1];
 
 	// Check if a blend info rebuild is required and upload fragment program
@@ -293,7 +351,7 @@ GLboolean _glDrawArrays_CustomShadersIMPL(GLsizei count) {
 	GLboolean is_packed = p->attr_num > 1;
 	if (is_packed) {
 		for (i = 0; i < p->attr_num; i++) {
-			if (vertex_attrib_vbo[real_i[i]]) {
+			if (vertex_attrib_vbo[real_i[i]] || (streams[i].indexSource & SCE_GXM_INDEX_SOURCE_INSTANCE_16BIT)) {
 				is_packed = GL_FALSE;
 				break;
 			}
@@ -304,8 +362,7 @@ GLboolean _glDrawArrays_CustomShadersIMPL(GLsizei count) {
 
 	// Gathering real attribute data pointers
 	if (is_packed) {
-		ptrs[0] = gpu_alloc_mapped_temp(count * streams[0].stride);
-		sceClibMemcpy(ptrs[0], (void *)vertex_attrib_offsets[real_i[0]], count * streams[0].stride);
+		ptrs[0] = upload_vertex_range((void *)vertex_attrib_offsets[real_i[0]], streams[0].stride, 0, count - 1);
 		for (i = 0; i < p->attr_num; i++) {
 			attributes[i].regIndex = p->attr[real_i[i]].regIndex;
 			if (vertex_attrib_state & (1 << real_i[i])) {
@@ -329,8 +386,7 @@ GLboolean _glDrawArrays_CustomShadersIMPL(GLsizei count) {
 #ifdef DRAW_SPEEDHACK
 					ptrs[i] = (void *)vertex_attrib_offsets[real_i[i]];
 #else
-					ptrs[i] = gpu_alloc_mapped_temp(count * streams[i].stride);
-					sceClibMemcpy(ptrs[i], (void *)vertex_attrib_offsets[real_i[i]], count * streams[i].stride);
+					ptrs[i] = upload_vertex_range((void *)vertex_attrib_offsets[real_i[i]], streams[i].stride, 0, (streams[i].indexSource & SCE_GXM_INDEX_SOURCE_INSTANCE_16BIT) ? instances - 1 : count - 1);
 #endif
 					attributes[i].offset = 0;
 				}
@@ -347,26 +403,16 @@ GLboolean _glDrawArrays_CustomShadersIMPL(GLsizei count) {
 	// Uploading both fragment and vertex uniforms data
 	void *buffer;
 	if (p->vert_uniforms && dirty_vert_unifs) {
-		vglReserveVertexUniformBuffer(p->vshader->prog, &buffer);
-		uniform *u = p->vert_uniforms;
-		while (u) {
-			sceGxmSetUniformDataF(buffer, u->ptr, 0, u->size, u->data);
-			u = (uniform *)u->chain;
-		}
+		if (vglReserveVertexUniformBuffer(p->vshader->prog, &buffer))
+			sceClibMemcpy(buffer, p->vert_unifs_shadow, p->vert_unifs_size);
 		dirty_vert_unifs = GL_FALSE;
 	}
 	if (p->frag_uniforms && dirty_frag_unifs) {
-		vglReserveFragmentUniformBuffer(p->fshader->prog, &buffer);
-		uniform *u = p->frag_uniforms;
-		while (u) {
-#ifdef HAVE_SAMPLERS_AS_UNIFORMS
-			if (u->size)
-#endif
-				sceGxmSetUniformDataF(buffer, u->ptr, 0, u->size, u->data);
-			u = (uniform *)u->chain;
-		}
+		if (vglReserveFragmentUniformBuffer(p->fshader->prog, &buffer))
+			sceClibMemcpy(buffer, p->frag_unifs_shadow, p->frag_unifs_size);
 		dirty_frag_unifs = GL_FALSE;
 	}
+	setup_uniform_buffers(p);
 
 	// Uploading vertex streams
 	for (i = 0; i < p->attr_num; i++) {
@@ -393,7 +439,7 @@ GLboolean _glDrawArrays_CustomShadersIMPL(GLsizei count) {
 	return GL_TRUE;
 }
 
-GLboolean _glDrawElements_CustomShadersIMPL(uint16_t *idx_buf, GLsizei count) {
+GLboolean _glDrawElements_CustomShadersIMPL(void *idx_buf, GLenum idx_type, GLsizei count, GLsizei instances, const uint32_t *idx_range) {
 	program *p = &progs[cur_program - 1];
 
 	// Check if a blend info rebuild is required and upload fragment program
@@ -450,6 +496,8 @@ GLboolean _glDrawElements_CustomShadersIMPL(uint16_t *idx_buf, GLsizei count) {
 			if (vertex_attrib_vbo[real_i[i]]) {
 				is_packed = GL_FALSE;
 			} else {
+				if (streams[i].indexSource & SCE_GXM_INDEX_SOURCE_INSTANCE_16BIT)
+					is_packed = GL_FALSE;
 				is_full_vbo = GL_FALSE;
 			}
 		}
@@ -458,20 +506,19 @@ GLboolean _glDrawElements_CustomShadersIMPL(uint16_t *idx_buf, GLsizei count) {
 	} else if (!vertex_attrib_vbo[real_i[0]])
 		is_full_vbo = GL_FALSE;
 
-	// Detecting highest index value
-	uint32_t top_idx = 0;
+	// Detecting lowest and highest index values
+	uint32_t min_idx, max_idx;
 	if (!is_full_vbo) {
-		for (i = 0; i < count; i++) {
-			if (idx_buf[i] > top_idx)
-				top_idx = idx_buf[i];
-		}
-		top_idx++;
+		if (idx_range) {
+			min_idx = idx_range[0];
+			max_idx = idx_range[1];
+		} else
+			get_index_range(idx_buf, idx_type, count, &min_idx, &max_idx);
 	}
 
 	// Gathering real attribute data pointers
 	if (is_packed) {
-		ptrs[0] = gpu_alloc_mapped_temp(top_idx * streams[0].stride);
-		sceClibMemcpy(ptrs[0], (void *)vertex_attrib_offsets[real_i[0]], top_idx * streams[0].stride);
+		ptrs[0] = upload_vertex_range((void *)vertex_attrib_offsets[real_i[0]], streams[0].stride, min_idx, max_idx);
 		for (i = 0; i < p->attr_num; i++) {
 			attributes[i].regIndex = p->attr[real_i[i]].regIndex;
 			if (vertex_attrib_state & (1 << real_i[i])) {
@@ -495,8 +542,10 @@ GLboolean _glDrawElements_CustomShadersIMPL(uint16_t *idx_buf, GLsizei count) {
 #ifdef DRAW_SPEEDHACK
 					ptrs[i] = (void *)vertex_attrib_offsets[real_i[i]];
 #else
-					ptrs[i] = gpu_alloc_mapped_temp(top_idx * streams[i].stride);
-					sceClibMemcpy(ptrs[i], (void *)vertex_attrib_offsets[real_i[i]], top_idx * streams[i].stride);
+					if (streams[i].indexSource & SCE_GXM_INDEX_SOURCE_INSTANCE_16BIT)
+						ptrs[i] = upload_vertex_range((void *)vertex_attrib_offsets[real_i[i]], streams[i].stride, 0, instances - 1);
+					else
+						ptrs[i] = upload_vertex_range((void *)vertex_attrib_offsets[real_i[i]], streams[i].stride, min_idx, max_idx);
 #endif
 					attributes[i].offset = 0;
 				}
@@ -506,33 +555,33 @@ GLboolean _glDrawElements_CustomShadersIMPL(uint16_t *idx_buf, GLsizei count) {
 		}
 	}
 
-	// Uploading new vertex program
+	// Uploading new vertex program (streams must be fetched with 32 bit indices when drawing with 32 bit index buffers)
+	if (idx_type == GL_UNSIGNED_INT) {
+		for (i = 0; i < p->attr_num; i++) {
+			streams[i].indexSource |= SCE_GXM_INDEX_SOURCE_INDEX_32BIT;
+		}
+	}
 	patchVertexProgram(gxm_shader_patcher, p->vshader->id, attributes, p->attr_num, streams, p->attr_num, &p->vprog);
+	if (idx_type == GL_UNSIGNED_INT) {
+		for (i = 0; i < p->attr_num; i++) {
+			streams[i].indexSource &= ~SCE_GXM_INDEX_SOURCE_INDEX_32BIT;
+		}
+	}
 	sceGxmSetVertexProgram(gxm_context, p->vprog);
 
 	// Uploading both fragment and vertex uniforms data
 	void *buffer;
 	if (p->vert_uniforms && dirty_vert_unifs) {
-		vglReserveVertexUniformBuffer(p->vshader->prog, &buffer);
-		uniform *u = p->vert_uniforms;
-		while (u) {
-			sceGxmSetUniformDataF(buffer, u->ptr, 0, u->size, u->data);
-			u = (uniform *)u->chain;
-		}
+		if (vglReserveVertexUniformBuffer(p->vshader->prog, &buffer))
+			sceClibMemcpy(buffer, p->vert_unifs_shadow, p->vert_unifs_size);
 		dirty_vert_unifs = GL_FALSE;
 	}
 	if (p->frag_uniforms && dirty_frag_unifs) {
-		vglReserveFragmentUniformBuffer(p->fshader->prog, &buffer);
-		uniform *u = p->frag_uniforms;
-		while (u) {
-#ifdef HAVE_SAMPLERS_AS_UNIFORMS
-			if (u->size)
-#endif
-				sceGxmSetUniformDataF(buffer, u->ptr, 0, u->size, u->data);
-			u = (uniform *)u->chain;
-		}
+		if (vglReserveFragmentUniformBuffer(p->fshader->prog, &buffer))
+			sceClibMemcpy(buffer, p->frag_unifs_shadow, p->frag_unifs_size);
 		dirty_frag_unifs = GL_FALSE;
 	}
+	setup_uniform_buffers(p);
 
 	// Uploading vertex streams
 	for (i = 0; i < p->attr_num; i++) {
@@ -575,30 +624,24 @@ void _vglDrawObjects_CustomShadersIMPL(GLboolean implicit_wvp) {
 	// Uploading both fragment and vertex uniforms data
 	void *buffer;
 	if (p->vert_uniforms && (dirty_vert_unifs || mvp_modified)) {
-		vglReserveVertexUniformBuffer(p->vshader->prog, &buffer);
-		uniform *u = p->vert_uniforms;
-		while (u) {
-			if (u->ptr == p->wvp && implicit_wvp) {
+		if (vglReserveVertexUniformBuffer(p->vshader->prog, &buffer)) {
+			sceClibMemcpy(buffer, p->vert_unifs_shadow, p->vert_unifs_size);
+			if (p->wvp && implicit_wvp) {
 				if (mvp_modified) {
 					matrix4x4_multiply(mvp_matrix, projection_matrix, modelview_matrix);
 					mvp_modified = GL_FALSE;
 				}
 				sceGxmSetUniformDataF(buffer, p->wvp, 0, 16, (const float *)mvp_matrix);
-			} else
-				sceGxmSetUniformDataF(buffer, u->ptr, 0, u->size, u->data);
-			u = (uniform *)u->chain;
+			}
 		}
 		dirty_vert_unifs = GL_FALSE;
 	}
 	if (p->frag_uniforms && dirty_frag_unifs) {
-		vglReserveFragmentUniformBuffer(p->fshader->prog, &buffer);
-		uniform *u = p->frag_uniforms;
-		while (u) {
-			sceGxmSetUniformDataF(buffer, u->ptr, 0, u->size, u->data);
-			u = (uniform *)u->chain;
-		}
+		if (vglReserveFragmentUniformBuffer(p->fshader->prog, &buffer))
+			sceClibMemcpy(buffer, p->frag_unifs_shadow, p->frag_unifs_size);
 		dirty_frag_unifs = GL_FALSE;
 	}
+	setup_uniform_buffers(p);
 
 	// Uploading textures on relative texture units
 	int i;
@@ -634,17 +677,82 @@ void shark_log_cb(const char *msg, shark_log_level msg_level, int line) {
 }
 #endif
 
-float *getUniformAliasDataPtr(uniform *u, const char *name, uint32_t size) {
+#ifndef DISABLE_ADVANCED_SHADER_CACHE
+static uint64_t hash_shader_source(shader *s) {
+	// FNV-1a hash over shader source, shader type and compiler settings
+	uint64_t hash = 14695981039346656037ull;
+	const uint8_t *src = (const uint8_t *)s->prog;
+	for (uint32_t i = 0; i < s->size; i++) {
+		hash = (hash ^ src[i]) * 1099511628211ull;
+	}
+	uint32_t opts[5] = {s->type, compiler_opts, compiler_fastmath, compiler_fastprecision, compiler_fastint};
+	src = (const uint8_t *)opts;
+	for (uint32_t i = 0; i < sizeof(opts); i++) {
+		hash = (hash ^ src[i]) * 1099511628211ull;
+	}
+	return hash;
+}
+#endif
+
+static inline uint32_t hash_param_name(const char *name) {
+	// FNV-1a hash
+	uint32_t hash = 2166136261u;
+	while (*name) {
+		hash = (hash ^ (uint8_t)*name++) * 16777619u;
+	}
+	return hash;
+}
+
+static param_entry *getParamEntry(program *p, const char *name) {
+	// Linear probing on the program parameters hash table (returns an empty slot if the name is not present)
+	uint32_t hash = hash_param_name(name);
+	uint32_t i = hash & p->params_mask;
+	while (p->params[i].name) {
+		if (p->params[i].hash == hash && !strcmp(p->params[i].name, name))
+			break;
+		i = (i + 1) & p->params_mask;
+	}
+	p->params[i].hash = hash;
+	return &p->params[i];
+}
+
+static void add_uniform_block(program *p, const SceGxmProgramParameter *param, GLboolean is_vertex) {
+	// Merging blocks with the same name in vertex and fragment programs into a single one
+	const char *name = sceGxmProgramParameterGetName(param);
 	int i;
-	while (u) {
-		if (size == u->size) {
-			if (!strcmp(name, sceGxmProgramParameterGetName(u->ptr))) {
-				return u->data;
-			}
+	for (i = 0; i < p->blocks_num; i++) {
+		if (!strcmp(p->blocks[i].name, name))
+			break;
+	}
+	if (i == p->blocks_num) {
+		if (p->blocks_num == UNIFORM_BUFFERS_NUM)
+			return;
+		p->blocks[i].name = name;
+		p->blocks[i].vert_idx = -1;
+		p->blocks[i].frag_idx = -1;
+		p->blocks[i].binding = 0;
+		p->blocks_num++;
+	}
+	if (is_vertex)
+		p->blocks[i].vert_idx = sceGxmProgramParameterGetResourceIndex(param);
+	else
+		p->blocks[i].frag_idx = sceGxmProgramParameterGetResourceIndex(param);
+}
+
+static inline void update_uniform(uniform *u) {
+	// Mirroring uniform data in the default uniform buffers images of the program
+	if (u->size) {
+		sceGxmSetUniformDataF(u->shadow, u->ptr, 0, u->size, u->data);
+		if (u->alias) {
+			uniform *a = (uniform *)u->alias;
+			sceGxmSetUniformDataF(a->shadow, a->ptr, 0, a->size, a->data);
 		}
-		u = u->chain;
 	}
-	return NULL;
+
+	if (u->is_vertex)
+		dirty_vert_unifs = GL_TRUE;
+	if (u->is_fragment)
+		dirty_frag_unifs = GL_TRUE;
 }
 
 /*
@@ -781,21 +889,71 @@ void glShaderBinary(GLsizei count, const GLuint *handles, GLenum binaryFormat, c
 }
 
 void glCompileShader(GLuint handle) {
-	// If vitaShaRK is not enabled, we try to initialize it
-	if (!is_shark_online && !startShaderCompiler()) {
-		SET_GL_ERROR(GL_INVALID_OPERATION)
-	}
-
 	// Grabbing passed shader
 	shader *s = &shaders[handle - 1];
+	SceGxmProgram *res = NULL;
+
+#ifndef DISABLE_ADVANCED_SHADER_CACHE
+	// Checking if the same source has already been compiled with the same compiler settings
+	char fname[256];
+	sprintf(fname, "ux0:data/shader_cache/c%d-%016llX.gxp", CUSTOM_SHADER_CACHE_MAGIC, hash_shader_source(s));
+	FILE *f = fopen(fname, "rb");
+	if (f) {
+		// Gathering the precompiled shader from cache
+		fseek(f, 0, SEEK_END);
+		long size = ftell(f);
+		fseek(f, 0, SEEK_SET);
+		if (size > 0) {
+			s->size = size;
+			res = (SceGxmProgram *)vgl_malloc(s->size, VGL_MEM_EXTERNAL);
+			if (res && (fread(res, 1, s->size, f) != s->size || sceGxmProgramCheck(res))) {
+				vgl_free(res);
+				res = NULL;
+			}
+		}
+		fclose(f);
 
-	// Compiling shader source
-	s->prog = shark_compile_shader_extended((const char *)s->prog, &s->size, s->type == GL_FRAGMENT_SHADER ? SHARK_FRAGMENT_SHADER : SHARK_VERTEX_SHADER, compiler_opts, compiler_fastmath, compiler_fastprecision, compiler_fastint);
-	if (s->prog) {
-		if (s->source)
+		// Discarding truncated or corrupted cache files and compiling the shader again
+		if (!res)
+			sceIoRemove(fname);
+	}
+	if (!res)
+#endif
+	{
+		// If vitaShaRK is not enabled, we try to initialize it
+		if (!is_shark_online && !startShaderCompiler()) {
+			SET_GL_ERROR(GL_INVALID_OPERATION)
+		}
+
+		// Compiling shader source
+		s->prog = shark_compile_shader_extended((const char *)s->prog, &s->size, s->type == GL_FRAGMENT_SHADER ? SHARK_FRAGMENT_SHADER : SHARK_VERTEX_SHADER, compiler_opts, compiler_fastmath, compiler_fastprecision, compiler_fastint);
+		if (s->prog) {
+			res = (SceGxmProgram *)vgl_malloc(s->size, VGL_MEM_EXTERNAL);
+			sceClibMemcpy((void *)res, (void *)s->prog, s->size);
+#ifndef DISABLE_ADVANCED_SHADER_CACHE
+			// Saving compiled shader in filesystem cache
+			f = fopen(fname, "wb");
+			if (f) {
+				fwrite(res, 1, s->size, f);
+				fclose(f);
+			}
+#endif
+		}
+#ifdef HAVE_SHARK_LOG
+		if (s->log)
+			vgl_free(s->log);
+		s->log = shark_log;
+		shark_log = NULL;
+#endif
+		shark_clear_output();
+	}
+
+	// Registering compiled shader into sceGxmShaderPatcher
+	if (res) {
+		if (s->source) {
 			vgl_free(s->source);
-		SceGxmProgram *res = (SceGxmProgram *)vgl_malloc(s->size, VGL_MEM_EXTERNAL);
-		sceClibMemcpy((void *)res, (void *)s->prog, s->size);
+			s->source = NULL;
+		}
 #ifdef LOG_ERRORS
 		int r = sceGxmShaderPatcherRegisterProgram(gxm_shader_patcher, res, &s->id);
 		if (r)
@@ -805,13 +963,6 @@ void glCompileShader(GLuint handle) {
 #endif
 		s->prog = sceGxmShaderPatcherGetProgramFromId(s->id);
 	}
-#ifdef HAVE_SHARK_LOG
-	if (s->log)
-		vgl_free(s->log);
-	s->log = shark_log;
-	shark_log = NULL;
-#endif
-	shark_clear_output();
 }
 
 void glDeleteShader(GLuint shad) {
@@ -855,6 +1006,16 @@ void glAttachShader(GLuint prog, GLuint shad) {
 	}
 }
 
+static void releaseBinaryShaders(program *p) {
+	// Deleting internal shaders created by glProgramBinary
+	for (int i = 0; i < 2; i++) {
+		if (p->binary_shaders[i]) {
+			glDeleteShader(p->binary_shaders[i]);
+			p->binary_shaders[i] = 0;
+		}
+	}
+}
+
 GLuint glCreateProgram(void) {
 	// Looking for a free program slot
 	GLuint i, j, res = 0;
@@ -871,7 +1032,13 @@ GLuint glCreateProgram(void) {
 			progs[i].fshader = NULL;
 			progs[i].vert_uniforms = NULL;
 			progs[i].frag_uniforms = NULL;
+			progs[i].vert_unifs_shadow = NULL;
+			progs[i].frag_unifs_shadow = NULL;
+			progs[i].params = NULL;
+			progs[i].blocks_num = 0;
 			progs[i].attr_highest_idx = 0;
+			progs[i].binary_shaders[0] = 0;
+			progs[i].binary_shaders[1] = 0;
 			for (j = 0; j < VERTEX_ATTRIBS_NUM; j++) {
 				progs[i].attr[j].regIndex = 0xDEAD;
 			}
@@ -906,6 +1073,19 @@ void glDeleteProgram(GLuint prog) {
 			vgl_free(old->data);
 			vgl_free(old);
 		}
+		if (p->vert_unifs_shadow) {
+			vgl_free(p->vert_unifs_shadow);
+			p->vert_unifs_shadow = NULL;
+		}
+		if (p->frag_unifs_shadow) {
+			vgl_free(p->frag_unifs_shadow);
+			p->frag_unifs_shadow = NULL;
+		}
+		if (p->params) {
+			vgl_free(p->params);
+			p->params = NULL;
+		}
+		releaseBinaryShaders(p);
 	}
 	p->status = PROG_INVALID;
 }
@@ -971,6 +1151,12 @@ void glGetProgramiv(GLuint progr, GLenum pname, GLint *params) {
 		}
 		*params = i;
 		break;
+	case GL_PROGRAM_BINARY_LENGTH:
+		if (p->status == PROG_LINKED)
+			*params = sizeof(program_binary_header) + sceGxmProgramGetSize(p->vshader->prog) + sceGxmProgramGetSize(p->fshader->prog);
+		else
+			*params = 0;
+		break;
 	case GL_ACTIVE_UNIFORMS:
 		i = 0;
 		u = p->vert_uniforms;
@@ -999,8 +1185,22 @@ void glLinkProgram(GLuint progr) {
 #endif
 	p->status = PROG_LINKED;
 
-	// Analyzing fragment shader
+	// Allocating parameters hash table (sized to keep load factor under 50%)
 	uint32_t i, cnt;
+	cnt = sceGxmProgramGetParameterCount(p->fshader->prog) + sceGxmProgramGetParameterCount(p->vshader->prog);
+	uint32_t params_size = 16;
+	while (params_size < cnt * 2) {
+		params_size <<= 1;
+	}
+	if (p->params)
+		vgl_free(p->params);
+	p->params = (param_entry *)vgl_malloc(params_size * sizeof(param_entry), VGL_MEM_EXTERNAL);
+	sceClibMemset(p->params, 0, params_size * sizeof(param_entry));
+	p->params_mask = params_size - 1;
+	param_entry *e;
+	p->blocks_num = 0;
+
+	// Analyzing fragment shader
 	for (i = 0; i < TEXTURE_IMAGE_UNITS_NUM; i++) {
 		p->texunits[i] = GL_FALSE;
 	}
@@ -1016,18 +1216,30 @@ void glLinkProgram(GLuint progr) {
 			u->ptr = param;
 			u->size = 0;
 			u->data = (float *)vgl_malloc(sizeof(float), VGL_MEM_EXTERNAL);
+			u->alias = NULL;
 			p->frag_uniforms = u;
+			e = getParamEntry(p, sceGxmProgramParameterGetName(param));
+			e->name = sceGxmProgramParameterGetName(param);
+			e->param = param;
+			e->u = u;
 #endif
-		} else if (cat == SCE_GXM_PARAMETER_CATEGORY_UNIFORM) {
+		} else if (cat == SCE_GXM_PARAMETER_CATEGORY_UNIFORM && sceGxmProgramParameterGetContainerIndex(param) == SCE_GXM_DEFAULT_UNIFORM_BUFFER_CONTAINER_INDEX) {
 			uniform *u = (uniform *)vgl_malloc(sizeof(uniform), VGL_MEM_EXTERNAL);
 			u->chain = p->frag_uniforms;
 			u->ptr = param;
 			u->is_vertex = GL_FALSE;
 			u->is_fragment = GL_TRUE;
+			u->alias = NULL;
 			u->size = sceGxmProgramParameterGetComponentCount(param) * sceGxmProgramParameterGetArraySize(param);
 			u->data = (float *)vgl_malloc(u->size * sizeof(float), VGL_MEM_EXTERNAL);
 			sceClibMemset(u->data, 0, u->size * sizeof(float));
 			p->frag_uniforms = u;
+			e = getParamEntry(p, sceGxmProgramParameterGetName(param));
+			e->name = sceGxmProgramParameterGetName(param);
+			e->param = param;
+			e->u = u;
+		} else if (cat == SCE_GXM_PARAMETER_CATEGORY_UNIFORM_BUFFER) {
+			add_uniform_block(p, param, GL_FALSE);
 		}
 	}
 
@@ -1039,14 +1251,20 @@ void glLinkProgram(GLuint progr) {
 		SceGxmParameterCategory cat = sceGxmProgramParameterGetCategory(param);
 		if (cat == SCE_GXM_PARAMETER_CATEGORY_ATTRIBUTE) {
 			p->attr_num++;
-		} else if (cat == SCE_GXM_PARAMETER_CATEGORY_UNIFORM) {
+			e = getParamEntry(p, sceGxmProgramParameterGetName(param));
+			e->name = sceGxmProgramParameterGetName(param);
+			e->param = param;
+			e->u = NULL;
+		} else if (cat == SCE_GXM_PARAMETER_CATEGORY_UNIFORM && sceGxmProgramParameterGetContainerIndex(param) == SCE_GXM_DEFAULT_UNIFORM_BUFFER_CONTAINER_INDEX) {
 			uniform *u = (uniform *)vgl_malloc(sizeof(uniform), VGL_MEM_EXTERNAL);
 			u->chain = p->vert_uniforms;
 			u->ptr = param;
 			u->is_vertex = GL_TRUE;
 			u->size = sceGxmProgramParameterGetComponentCount(param) * sceGxmProgramParameterGetArraySize(param);
-			u->data = getUniformAliasDataPtr(p->frag_uniforms, sceGxmProgramParameterGetName(param), u->size);
-			if (u->data) {
+			e = getParamEntry(p, sceGxmProgramParameterGetName(param));
+			u->alias = (e->u && e->u->size == u->size) ? e->u : NULL;
+			if (u->alias) {
+				u->data = ((uniform *)u->alias)->data;
 				u->is_fragment = GL_TRUE;
 			} else {
 				u->is_fragment = GL_FALSE;
@@ -1054,9 +1272,42 @@ void glLinkProgram(GLuint progr) {
 				sceClibMemset(u->data, 0, u->size * sizeof(float));
 			}
 			p->vert_uniforms = u;
+
+			// Vertex uniforms take precedence over fragment ones for glGetUniformLocation
+			e->name = sceGxmProgramParameterGetName(param);
+			e->param = param;
+			e->u = u;
+		} else if (cat == SCE_GXM_PARAMETER_CATEGORY_UNIFORM_BUFFER) {
+			add_uniform_block(p, param, GL_TRUE);
 		}
 	}
 
+	// Laying out default uniform buffers images so that draws can upload them with a single copy
+	if (p->vert_unifs_shadow)
+		vgl_free(p->vert_unifs_shadow);
+	if (p->frag_unifs_shadow)
+		vgl_free(p->frag_unifs_shadow);
+	p->vert_unifs_size = sceGxmProgramGetDefaultUniformBufferSize(p->vshader->prog);
+	p->frag_unifs_size = sceGxmProgramGetDefaultUniformBufferSize(p->fshader->prog);
+	p->vert_unifs_shadow = vgl_malloc(p->vert_unifs_size ? p->vert_unifs_size : 4, VGL_MEM_EXTERNAL);
+	p->frag_unifs_shadow = vgl_malloc(p->frag_unifs_size ? p->frag_unifs_size : 4, VGL_MEM_EXTERNAL);
+	sceClibMemset(p->vert_unifs_shadow, 0, p->vert_unifs_size);
+	sceClibMemset(p->frag_unifs_shadow, 0, p->frag_unifs_size);
+	uniform *u = p->vert_uniforms;
+	while (u) {
+		u->shadow = p->vert_unifs_shadow;
+		if (u->size)
+			sceGxmSetUniformDataF(u->shadow, u->ptr, 0, u->size, u->data);
+		u = (uniform *)u->chain;
+	}
+	u = p->frag_uniforms;
+	while (u) {
+		u->shadow = p->frag_unifs_shadow;
+		if (u->size)
+			sceGxmSetUniformDataF(u->shadow, u->ptr, 0, u->size, u->data);
+		u = (uniform *)u->chain;
+	}
+
 	// Creating fragment and vertex program via sceGxmShaderPatcher if using vgl* draw pipeline
 	if (p->stream_num) {
 		if (p->stream_num > 1)
@@ -1082,6 +1333,97 @@ void glLinkProgram(GLuint progr) {
 	}
 }
 
+void glGetProgramBinary(GLuint prog, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary) {
+	// Grabbing passed program
+	program *p = &progs[prog - 1];
+#ifndef SKIP_ERROR_HANDLING
+	if (p->status != PROG_LINKED) {
+		if (length)
+			*length = 0;
+		SET_GL_ERROR(GL_INVALID_OPERATION)
+	}
+#endif
+
+	uint32_t vert_size = sceGxmProgramGetSize(p->vshader->prog);
+	uint32_t frag_size = sceGxmProgramGetSize(p->fshader->prog);
+	uint32_t size = sizeof(program_binary_header) + vert_size + frag_size;
+#ifndef SKIP_ERROR_HANDLING
+	if (bufSize < size) {
+		if (length)
+			*length = 0;
+		SET_GL_ERROR(GL_INVALID_OPERATION)
+	}
+#endif
+
+	// Serializing attributes bindings followed by both compiled shaders
+	program_binary_header *hdr = (program_binary_header *)binary;
+	hdr->magic = PROGRAM_BINARY_MAGIC;
+	hdr->version = PROGRAM_BINARY_VERSION;
+	hdr->vert_size = vert_size;
+	hdr->frag_size = frag_size;
+	hdr->stream_num = p->stream_num;
+	hdr->attr_highest_idx = p->attr_highest_idx;
+	sceClibMemcpy(hdr->attr, p->attr, sizeof(p->attr));
+	sceClibMemcpy(hdr->stream, p->stream, sizeof(p->stream));
+	uint8_t *data = (uint8_t *)binary + sizeof(program_binary_header);
+	sceClibMemcpy(data, p->vshader->prog, vert_size);
+	sceClibMemcpy(data + vert_size, p->fshader->prog, frag_size);
+
+	if (length)
+		*length = size;
+	*binaryFormat = GL_SGX_PROGRAM_BINARY_IMG;
+}
+
+void glProgramBinary(GLuint prog, GLenum binaryFormat, const void *binary, GLsizei length) {
+#ifndef SKIP_ERROR_HANDLING
+	if (binaryFormat != GL_SGX_PROGRAM_BINARY_IMG) {
+		SET_GL_ERROR(GL_INVALID_ENUM)
+	}
+#endif
+
+	// Grabbing passed program
+	program *p = &progs[prog - 1];
+	const program_binary_header *hdr = (const program_binary_header *)binary;
+
+	// Rejecting blobs not produced by this vitaGL build or corrupted (link status is reported as failed)
+	if (length < sizeof(program_binary_header) || hdr->magic != PROGRAM_BINARY_MAGIC || hdr->version != PROGRAM_BINARY_VERSION ||
+		hdr->vert_size > length || hdr->frag_size > length || length != sizeof(program_binary_header) + hdr->vert_size + hdr->frag_size ||
+		hdr->stream_num > VERTEX_ATTRIBS_NUM || hdr->attr_highest_idx > VERTEX_ATTRIBS_NUM) {
+		p->status = PROG_UNLINKED;
+		return;
+	}
+	const uint8_t *data = (const uint8_t *)binary + sizeof(program_binary_header);
+	const SceGxmProgram *vert_prog = (const SceGxmProgram *)data;
+	const SceGxmProgram *frag_prog = (const SceGxmProgram *)(data + hdr->vert_size);
+	if (sceGxmProgramCheck(vert_prog) || sceGxmProgramGetSize(vert_prog) != hdr->vert_size ||
+		sceGxmProgramCheck(frag_prog) || sceGxmProgramGetSize(frag_prog) != hdr->frag_size) {
+		p->status = PROG_UNLINKED;
+		return;
+	}
+
+	// Registering stored shaders into internal shader slots owned by the program
+	releaseBinaryShaders(p);
+	p->binary_shaders[0] = glCreateShader(GL_VERTEX_SHADER);
+	p->binary_shaders[1] = glCreateShader(GL_FRAGMENT_SHADER);
+	if (!p->binary_shaders[0] || !p->binary_shaders[1]) {
+		releaseBinaryShaders(p);
+		p->status = PROG_UNLINKED;
+		return;
+	}
+	glShaderBinary(1, &p->binary_shaders[0], binaryFormat, data, hdr->vert_size);
+	glShaderBinary(1, &p->binary_shaders[1], binaryFormat, data + hdr->vert_size, hdr->frag_size);
+	p->vshader = &shaders[p->binary_shaders[0] - 1];
+	p->fshader = &shaders[p->binary_shaders[1] - 1];
+
+	// Restoring attributes bindings and linking the program
+	sceClibMemcpy(p->attr, hdr->attr, sizeof(p->attr));
+	sceClibMemcpy(p->stream, hdr->stream, sizeof(p->stream));
+	p->stream_num = hdr->stream_num;
+	p->attr_highest_idx = hdr->attr_highest_idx;
+	p->attr_num = 0;
+	glLinkProgram(prog);
+}
+
 void glUseProgram(GLuint prog) {
 	// Setting current custom program to passed program
 	cur_program = prog;
@@ -1089,30 +1431,41 @@ void glUseProgram(GLuint prog) {
 	dirty_vert_unifs = GL_TRUE;
 }
 
-GLint glGetUniformLocation(GLuint prog, const GLchar *name) {
+GLuint glGetUniformBlockIndex(GLuint prog, const GLchar *name) {
 	// Grabbing passed program
 	program *p = &progs[prog - 1];
 
-	// Checking if parameter is a vertex or fragment related one
-	uniform *j;
-	const SceGxmProgramParameter *u = sceGxmProgramFindParameterByName(p->vshader->prog, name);
-	if (u == NULL) {
-		u = sceGxmProgramFindParameterByName(p->fshader->prog, name);
-		if (u == NULL)
-			return -1;
-		else
-			j = p->frag_uniforms;
-	} else
-		j = p->vert_uniforms;
+	for (GLuint i = 0; i < p->blocks_num; i++) {
+		if (!strcmp(p->blocks[i].name, name))
+			return i;
+	}
 
-	// Getting the desired location
-	while (j) {
-		if (j->ptr == u)
-			return -((GLint)j);
-		j = j->chain;
+	return GL_INVALID_INDEX;
+}
+
+void glUniformBlockBinding(GLuint prog, GLuint uniformBlockIndex, GLuint uniformBlockBinding) {
+	// Grabbing passed program
+	program *p = &progs[prog - 1];
+#ifndef SKIP_ERROR_HANDLING
+	if (uniformBlockIndex >= p->blocks_num || uniformBlockBinding >= UNIFORM_BUFFERS_NUM) {
+		SET_GL_ERROR(GL_INVALID_VALUE)
 	}
+#endif
 
-	return -1;
+	p->blocks[uniformBlockIndex].binding = uniformBlockBinding;
+}
+
+GLint glGetUniformLocation(GLuint prog, const GLchar *name) {
+	// Grabbing passed program
+	program *p = &progs[prog - 1];
+
+	// Getting the desired location from the parameters hash table
+	if (!p->params)
+		return -1;
+	param_entry *e = getParamEntry(p, name);
+	if (!e->u)
+		return -1;
+	return -((GLint)e->u);
 }
 
 void glUniform1i(GLint location, GLint v0) {
@@ -1125,11 +1478,8 @@ void glUniform1i(GLint location, GLint v0) {
 
 	// Setting passed value to desired uniform
 	u->data[0] = (float)v0;
-	
-	if (u->is_vertex)
-		dirty_vert_unifs = GL_TRUE;
-	if (u->is_fragment)
-		dirty_frag_unifs = GL_TRUE;
+
+	update_uniform(u);
 }
 
 void glUniform1iv(GLint location, GLsizei count, const GLint *value) {
@@ -1145,11 +1495,8 @@ void glUniform1iv(GLint location, GLsizei count, const GLint *value) {
 	for (i = 0; i < count; i++) {
 		u->data[i] = (float)value[i];
 	}
-	
-	if (u->is_vertex)
-		dirty_vert_unifs = GL_TRUE;
-	if (u->is_fragment)
-		dirty_frag_unifs = GL_TRUE;
+
+	update_uniform(u);
 }
 
 void glUniform1f(GLint location, GLfloat v0) {
@@ -1162,11 +1509,8 @@ void glUniform1f(GLint location, GLfloat v0) {
 
 	// Setting passed value to desired uniform
 	u->data[0] = v0;
-	
-	if (u->is_vertex)
-		dirty_vert_unifs = GL_TRUE;
-	if (u->is_fragment)
-		dirty_frag_unifs = GL_TRUE;
+
+	update_uniform(u);
 }
 
 void glUniform1fv(GLint location, GLsizei count, const GLfloat *value) {
@@ -1179,11 +1523,8 @@ void glUniform1fv(GLint location, GLsizei count, const GLfloat *value) {
 
 	// Setting passed value to desired uniform
 	sceClibMemcpy(u->data, value, count * sizeof(float));
-	
-	if (u->is_vertex)
-		dirty_vert_unifs = GL_TRUE;
-	if (u->is_fragment)
-		dirty_frag_unifs = GL_TRUE;
+
+	update_uniform(u);
 }
 
 void glUniform2i(GLint location, GLint v0, GLint v1) {
@@ -1197,11 +1538,8 @@ void glUniform2i(GLint location, GLint v0, GLint v1) {
 	// Setting passed value to desired uniform
 	u->data[0] = (float)v0;
 	u->data[1] = (float)v1;
-	
-	if (u->is_vertex)
-		dirty_vert_unifs = GL_TRUE;
-	if (u->is_fragment)
-		dirty_frag_unifs = GL_TRUE;
+
+	update_uniform(u);
 }
 
 void glUniform2iv(GLint location, GLsizei count, const GLint *value) {
@@ -1217,11 +1555,8 @@ void glUniform2iv(GLint location, GLsizei count, const GLint *value) {
 	for (i = 0; i < count * 2; i++) {
 		u->data[i] = (float)value[i];
 	}
-	
-	if (u->is_vertex)
-		dirty_vert_unifs = GL_TRUE;
-	if (u->is_fragment)
-		dirty_frag_unifs = GL_TRUE;
+
+	update_uniform(u);
 }
 
 void glUniform2f(GLint location, GLfloat v0, GLfloat v1) {
@@ -1235,11 +1570,8 @@ void glUniform2f(GLint location, GLfloat v0, GLfloat v1) {
 	// Setting passed value to desired uniform
 	u->data[0] = v0;
 	u->data[1] = v1;
-	
-	if (u->is_vertex)
-		dirty_vert_unifs = GL_TRUE;
-	if (u->is_fragment)
-		dirty_frag_unifs = GL_TRUE;
+
+	update_uniform(u);
 }
 
 void glUniform2fv(GLint location, GLsizei count, const GLfloat *value) {
@@ -1252,11 +1584,8 @@ void glUniform2fv(GLint location, GLsizei count, const GLfloat *value) {
 
 	// Setting passed value to desired uniform
 	sceClibMemcpy(u->data, value, count * 2 * sizeof(float));
-	
-	if (u->is_vertex)
-		dirty_vert_unifs = GL_TRUE;
-	if (u->is_fragment)
-		dirty_frag_unifs = GL_TRUE;
+
+	update_uniform(u);
 }
 
 void glUniform3i(GLint location, GLint v0, GLint v1, GLint v2) {
@@ -1271,11 +1600,8 @@ void glUniform3i(GLint location, GLint v0, GLint v1, GLint v2) {
 	u->data[0] = (float)v0;
 	u->data[1] = (float)v1;
 	u->data[2] = (float)v2;
-	
-	if (u->is_vertex)
-		dirty_vert_unifs = GL_TRUE;
-	if (u->is_fragment)
-		dirty_frag_unifs = GL_TRUE;
+
+	update_uniform(u);
 }
 
 void glUniform3iv(GLint location, GLsizei count, const GLint *value) {
@@ -1291,11 +1617,8 @@ void glUniform3iv(GLint location, GLsizei count, const GLint *value) {
 	for (i = 0; i < count * 3; i++) {
 		u->data[i] = (float)value[i];
 	}
-	
-	if (u->is_vertex)
-		dirty_vert_unifs = GL_TRUE;
-	if (u->is_fragment)
-		dirty_frag_unifs = GL_TRUE;
+
+	update_uniform(u);
 }
 
 void glUniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2) {
@@ -1310,11 +1633,8 @@ void glUniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2) {
 	u->data[0] = v0;
 	u->data[1] = v1;
 	u->data[2] = v2;
-	
-	if (u->is_vertex)
-		dirty_vert_unifs = GL_TRUE;
-	if (u->is_fragment)
-		dirty_frag_unifs = GL_TRUE;
+
+	update_uniform(u);
 }
 
 void glUniform3fv(GLint location, GLsizei count, const GLfloat *value) {
@@ -1327,11 +1647,8 @@ void glUniform3fv(GLint location, GLsizei count, const GLfloat *value) {
 
 	// Setting passed value to desired uniform
 	sceClibMemcpy(u->data, value, count * 3 * sizeof(float));
-	
-	if (u->is_vertex)
-		dirty_vert_unifs = GL_TRUE;
-	if (u->is_fragment)
-		dirty_frag_unifs = GL_TRUE;
+
+	update_uniform(u);
 }
 
 void glUniform4i(GLint location, GLint v0, GLint v1, GLint v2, GLint v3) {
@@ -1347,11 +1664,8 @@ void glUniform4i(GLint location, GLint v0, GLint v1, GLint v2, GLint v3) {
 	u->data[1] = (float)v1;
 	u->data[2] = (float)v2;
 	u->data[3] = (float)v3;
-	
-	if (u->is_vertex)
-		dirty_vert_unifs = GL_TRUE;
-	if (u->is_fragment)
-		dirty_frag_unifs = GL_TRUE;
+
+	update_uniform(u);
 }
 
 void glUniform4iv(GLint location, GLsizei count, const GLint *value) {
@@ -1367,11 +1681,8 @@ void glUniform4iv(GLint location, GLsizei count, const GLint *value) {
 	for (i = 0; i < count * 4; i++) {
 		u->data[i] = (float)value[i];
 	}
-	
-	if (u->is_vertex)
-		dirty_vert_unifs = GL_TRUE;
-	if (u->is_fragment)
-		dirty_frag_unifs = GL_TRUE;
+
+	update_uniform(u);
 }
 
 void glUniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3) {
@@ -1387,11 +1698,8 @@ void glUniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3)
 	u->data[1] = v1;
 	u->data[2] = v2;
 	u->data[3] = v3;
-	
-	if (u->is_vertex)
-		dirty_vert_unifs = GL_TRUE;
-	if (u->is_fragment)
-		dirty_frag_unifs = GL_TRUE;
+
+	update_uniform(u);
 }
 
 void glUniform4fv(GLint location, GLsizei count, const GLfloat *value) {
@@ -1404,11 +1712,8 @@ void glUniform4fv(GLint location, GLsizei count, const GLfloat *value) {
 
 	// Setting passed value to desired uniform
 	sceClibMemcpy(u->data, value, count * 4 * sizeof(float));
-	
-	if (u->is_vertex)
-		dirty_vert_unifs = GL_TRUE;
-	if (u->is_fragment)
-		dirty_frag_unifs = GL_TRUE;
+
+	update_uniform(u);
 }
 
 void glUniformMatrix2fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value) {
@@ -1421,11 +1726,8 @@ void glUniformMatrix2fv(GLint location, GLsizei count, GLboolean transpose, cons
 
 	// Setting passed value to desired uniform
 	sceClibMemcpy(u->data, value, count * 4 * sizeof(float));
-	
-	if (u->is_vertex)
-		dirty_vert_unifs = GL_TRUE;
-	if (u->is_fragment)
-		dirty_frag_unifs = GL_TRUE;
+
+	update_uniform(u);
 }
 
 void glUniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value) {
@@ -1438,11 +1740,8 @@ void glUniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, cons
 
 	// Setting passed value to desired uniform
 	sceClibMemcpy(u->data, value, count * 9 * sizeof(float));
-	
-	if (u->is_vertex)
-		dirty_vert_unifs = GL_TRUE;
-	if (u->is_fragment)
-		dirty_frag_unifs = GL_TRUE;
+
+	update_uniform(u);
 }
 
 void glUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value) {
@@ -1455,11 +1754,8 @@ void glUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, cons
 
 	// Setting passed value to desired uniform
 	sceClibMemcpy(u->data, value, count * 16 * sizeof(float));
-	
-	if (u->is_vertex)
-		dirty_vert_unifs = GL_TRUE;
-	if (u->is_fragment)
-		dirty_frag_unifs = GL_TRUE;
+
+	update_uniform(u);
 }
 
 void glEnableVertexAttribArray(GLuint index) {
@@ -1538,6 +1834,17 @@ void glVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean norm
 	streams->stride = stride ? stride : bpe * size;
 }
 
+void glVertexAttribDivisor(GLuint index, GLuint divisor) {
+#ifndef SKIP_ERROR_HANDLING
+	if (index >= VERTEX_ATTRIBS_NUM || divisor > 1) {
+		SET_GL_ERROR(GL_INVALID_VALUE)
+	}
+#endif
+
+	// sceGxm streams can only advance per vertex or per instance
+	vertex_stream_config[index].indexSource = divisor ? SCE_GXM_INDEX_SOURCE_INSTANCE_16BIT : SCE_GXM_INDEX_SOURCE_INDEX_16BIT;
+}
+
 void glGetVertexAttribiv(GLuint index, GLenum pname, GLint *params) {
 #ifndef SKIP_ERROR_HANDLING
 	if (index >= VERTEX_ATTRIBS_NUM) {
@@ -1563,6 +1870,9 @@ void glGetVertexAttribiv(GLuint index, GLenum pname, GLint *params) {
 	case GL_VERTEX_ATTRIB_ARRAY_NORMALIZED:
 		params[0] = (vertex_attrib_state & (1 << index)) ? (vertex_attrib_config[index].format >= SCE_GXM_ATTRIBUTE_FORMAT_U8N && vertex_attrib_config[index].format <= SCE_GXM_ATTRIBUTE_FORMAT_S16N) : GL_FALSE;
 		break;
+	case GL_VERTEX_ATTRIB_ARRAY_DIVISOR:
+		params[0] = (vertex_stream_config[index].indexSource & SCE_GXM_INDEX_SOURCE_INSTANCE_16BIT) ? 1 : 0;
+		break;
 	case GL_CURRENT_VERTEX_ATTRIB:
 #ifndef SKIP_ERROR_HANDLING
 		if (index == 0) {
@@ -1604,6 +1914,9 @@ void glGetVertexAttribfv(GLuint index, GLenum pname, GLfloat *params) {
 	case GL_VERTEX_ATTRIB_ARRAY_NORMALIZED:
 		params[0] = (vertex_attrib_state & (1 << index)) ? (vertex_attrib_config[index].format >= SCE_GXM_ATTRIBUTE_FORMAT_U8N && vertex_attrib_config[index].format <= SCE_GXM_ATTRIBUTE_FORMAT_S16N) : GL_FALSE;
 		break;
+	case GL_VERTEX_ATTRIB_ARRAY_DIVISOR:
+		params[0] = (vertex_stream_config[index].indexSource & SCE_GXM_INDEX_SOURCE_INSTANCE_16BIT) ? 1 : 0;
+		break;
 	case GL_CURRENT_VERTEX_ATTRIB:
 #ifndef SKIP_ERROR_HANDLING
 		if (index == 0) {
@@ -1690,7 +2003,12 @@ void glBindAttribLocation(GLuint prog, GLuint index, const GLchar *name) {
 
 GLint glGetAttribLocation(GLuint prog, const GLchar *name) {
 	program *p = &progs[prog - 1];
-	const SceGxmProgramParameter *param = sceGxmProgramFindParameterByName(p->vshader->prog, name);
+	const SceGxmProgramParameter *param;
+	if (p->params) {
+		param_entry *e = getParamEntry(p, name);
+		param = e->u ? NULL : e->param;
+	} else
+		param = sceGxmProgramFindParameterByName(p->vshader->prog, name);
 	if (param == NULL || sceGxmProgramParameterGetCategory(param) != SCE_GXM_PARAMETER_CATEGORY_ATTRIBUTE)
 		return -1;
 	int index = sceGxmProgramParameterGetResourceIndex(param);
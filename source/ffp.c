@@ -64,6 +64,92 @@ legacy_vtx_attachment current_vtx = {
 	.emiss = {0.0f, 0.0f, 0.0f, 1.0f},
 	.nor = {0.0f, 0.0f, 1.0f}};
 
+typedef enum {
+	LEGACY_LAYOUT_COMPACT, // Position and texcoord, color is provided through tint uniform
+	LEGACY_LAYOUT_COMPACT_COLOR, // Position, texcoord and U8N color
+	LEGACY_LAYOUT_FULL // Position, texcoord, materials and normal (used with lighting)
+} legacyLayout;
+static const uint8_t legacy_layout_strides[] = {LEGACY_VERTEX_COMPACT_STRIDE, LEGACY_VERTEX_COMPACT_COLOR_STRIDE, LEGACY_VERTEX_STRIDE};
+static legacyLayout legacy_layout = LEGACY_LAYOUT_FULL; // Vertex layout for the current glBegin/glEnd block
+static GLboolean is_legacy_block = GL_FALSE; // Flag for when a glBegin/glEnd block is being populated
+static vector4f legacy_block_clr; // Color shared by all the vertices of the current block with compact layout
+static uint32_t legacy_packed_clr; // Current color in U8N format for compact color layout
+
+static uint32_t legacy_pool_usage = 0; // Immediate mode mempool usage in bytes for the current frame
+static uint32_t legacy_pool_peak = 0; // Highest immediate mode mempool usage in bytes for a single frame
+static uint32_t legacy_pool_chunks = 0; // Number of extra chunks allocated due to immediate mode mempool overflows
+
+static float *legacy_draw_ptr; // Vertices of the pending immediate mode draw
+static GLenum legacy_draw_mode; // Primitive of the pending immediate mode draw
+static SceGxmPrimitiveType legacy_draw_prim; // sceGxm primitive of the pending immediate mode draw
+static legacyLayout legacy_draw_layout; // Vertex layout of the pending immediate mode draw
+static uint8_t legacy_draw_streams_num; // Number of vertex streams of the pending immediate mode draw
+static SceGxmTexture legacy_draw_texture; // Texture used by the pending immediate mode draw
+uint32_t legacy_draw_count = 0; // Number of vertices of the pending immediate mode draw (0 = No pending draw)
+
+void resetLegacyPool(void) {
+	if (legacy_pool_size) {
+		legacy_pool = (float *)gpu_alloc_mapped_temp(legacy_pool_size);
+		legacy_pool_end = legacy_pool + legacy_pool_size / sizeof(float);
+	} else {
+		legacy_pool = NULL;
+		legacy_pool_end = NULL;
+	}
+	legacy_pool_ptr = legacy_pool;
+	legacy_pool_usage = 0;
+}
+
+static void grow_legacy_pool(uint32_t extra) {
+	// Allocating a new chunk big enough for the current block plus the requested extra space
+	uint32_t used = legacy_pool_ptr - legacy_pool;
+	uint32_t size = max((uint32_t)legacy_pool_size, (used + extra) * sizeof(float) * 2);
+	float *chunk = (float *)gpu_alloc_mapped_temp(size);
+
+	// Moving vertices of the current block to the new chunk
+	sceClibMemcpy(chunk, legacy_pool, used * sizeof(float));
+	legacy_pool = chunk;
+	legacy_pool_ptr = chunk + used;
+	legacy_pool_end = chunk + size / sizeof(float);
+	legacy_pool_chunks++;
+}
+
+static uint32_t pack_color(const vector4f *c) {
+	return (uint32_t)(min(max(c->r, 0.0f), 1.0f) * 255.0f) |
+		((uint32_t)(min(max(c->g, 0.0f), 1.0f) * 255.0f) << 8) |
+		((uint32_t)(min(max(c->b, 0.0f), 1.0f) * 255.0f) << 16) |
+		((uint32_t)(min(max(c->a, 0.0f), 1.0f) * 255.0f) << 24);
+}
+
+static void track_legacy_color(void) {
+	if (!is_legacy_block)
+		return;
+
+	if (legacy_layout == LEGACY_LAYOUT_COMPACT) {
+		// Color can't be provided through uniform anymore if it changes after the first vertex
+		if (!vertex_count || !sceClibMemcmp(&legacy_block_clr, &current_vtx.clr, sizeof(vector4f)))
+			return;
+
+		// Making room for the bigger layout
+		if (legacy_pool + vertex_count * LEGACY_VERTEX_COMPACT_COLOR_STRIDE > legacy_pool_end)
+			grow_legacy_pool(vertex_count * (LEGACY_VERTEX_COMPACT_COLOR_STRIDE - LEGACY_VERTEX_COMPACT_STRIDE));
+
+		// Expanding already staged vertices to compact color layout (backwards since the layout grows in place)
+		uint32_t clr = pack_color(&legacy_block_clr);
+		for (int i = vertex_count - 1; i >= 0; i--) {
+			float *src = legacy_pool + i * LEGACY_VERTEX_COMPACT_STRIDE;
+			float *dst = legacy_pool + i * LEGACY_VERTEX_COMPACT_COLOR_STRIDE;
+			for (int j = LEGACY_VERTEX_COMPACT_STRIDE - 1; j >= 0; j--) {
+				dst[j] = src[j];
+			}
+			*(uint32_t *)&dst[LEGACY_VERTEX_COMPACT_STRIDE] = clr;
+		}
+		legacy_pool_ptr = legacy_pool + vertex_count * LEGACY_VERTEX_COMPACT_COLOR_STRIDE;
+		legacy_layout = LEGACY_LAYOUT_COMPACT_COLOR;
+	}
+	if (legacy_layout == LEGACY_LAYOUT_COMPACT_COLOR)
+		legacy_packed_clr = pack_color(&current_vtx.clr);
+}
+
 SceGxmVertexAttribute ffp_vertex_attrib_config[FFP_VERTEX_ATTRIBS_NUM];
 SceGxmVertexStream ffp_vertex_stream_config[FFP_VERTEX_ATTRIBS_NUM];
 SceGxmVertexAttribute legacy_vertex_attrib_config[FFP_VERTEX_ATTRIBS_NUM];
@@ -73,6 +159,7 @@ static uint32_t ffp_vertex_attrib_vbo[FFP_VERTEX_ATTRIBS_NUM] = {0, 0, 0, 0, 0,
 uint16_t ffp_vertex_attrib_state = 0;
 static GLenum ffp_mode;
 static uint8_t texcoord_idxs[TEXTURE_COORDS_NUM] = {1, FFP_VERTEX_ATTRIBS_NUM - 1};
+static uint16_t ffp_index_source = SCE_GXM_INDEX_SOURCE_INDEX_16BIT; // Index source for ffp vertex streams (32 bit only for draws with 32 bit indices)
 
 typedef union shader_mask {
 	struct {
@@ -149,6 +236,7 @@ GLboolean ffp_dirty_frag = GL_TRUE;
 GLboolean ffp_dirty_vert = GL_TRUE;
 GLboolean dirty_frag_unifs = GL_TRUE;
 GLboolean dirty_vert_unifs = GL_TRUE;
+static GLboolean dirty_tint_color = GL_TRUE; // Flag for when tint color uniform (used only without per vertex colors) needs to be updated
 blend_config ffp_blend_info;
 shader_mask ffp_mask = {.raw = 0};
 #ifndef DISABLE_TEXTURE_COMBINER
@@ -256,36 +344,36 @@ void setup_combiner_pass(int i, char *dst) {
 }
 #endif
 
-void reload_ffp_shaders(SceGxmVertexAttribute *attrs, SceGxmVertexStream *streams) {
-	// Checking if mask changed
-	texture_unit *tex_unit = &texture_units[client_texture_unit];
-	GLboolean ffp_dirty_frag_blend = ffp_blend_info.raw != blend_info.raw;
-	shader_mask mask = {.raw = 0};
 #ifndef DISABLE_TEXTURE_COMBINER
-	combiner_mask cmb_mask = {.raw = 0};
+static void build_ffp_mask(SceGxmVertexAttribute *attrs, shader_mask *mask, combiner_mask *cmb_mask) {
+#else
+static void build_ffp_mask(SceGxmVertexAttribute *attrs, shader_mask *mask) {
 #endif
-	mask.alpha_test_mode = alpha_op;
-	mask.has_colors = (ffp_vertex_attrib_state & (1 << 2)) ? GL_TRUE : GL_FALSE;
-	mask.fog_mode = internal_fog_mode;
-	
+	mask->raw = 0;
+#ifndef DISABLE_TEXTURE_COMBINER
+	cmb_mask->raw = 0;
+#endif
+	mask->alpha_test_mode = alpha_op;
+	mask->has_colors = (ffp_vertex_attrib_state & (1 << 2)) ? GL_TRUE : GL_FALSE;
+	mask->fog_mode = internal_fog_mode;
+
 	// Counting number of enabled texture units
-	mask.num_textures = 0;
 	for (int i = 0; i < TEXTURE_COORDS_NUM; i++) {
 		if ((texture_units[i].enabled || attrs == legacy_vertex_attrib_config) && (ffp_vertex_attrib_state & (1 << texcoord_idxs[i]))) {
-			mask.num_textures++;
+			mask->num_textures++;
 			switch (i) {
 			case 0:
-				mask.tex_env_mode_pass0 = texture_units[0].env_mode;
+				mask->tex_env_mode_pass0 = texture_units[0].env_mode;
 #ifndef DISABLE_TEXTURE_COMBINER
-				if (mask.tex_env_mode_pass0 == COMBINE)
-					cmb_mask.pass0.raw = texture_units[0].combiner.raw;
+				if (mask->tex_env_mode_pass0 == COMBINE)
+					cmb_mask->pass0.raw = texture_units[0].combiner.raw;
 #endif
 				break;
 			case 1:
-				mask.tex_env_mode_pass1 = texture_units[1].env_mode;
+				mask->tex_env_mode_pass1 = texture_units[1].env_mode;
 #ifndef DISABLE_TEXTURE_COMBINER
-				if (mask.tex_env_mode_pass1 == COMBINE)
-					cmb_mask.pass1.raw = texture_units[1].combiner.raw;
+				if (mask->tex_env_mode_pass1 == COMBINE)
+					cmb_mask->pass1.raw = texture_units[1].combiner.raw;
 #endif
 				break;
 			default:
@@ -294,41 +382,54 @@ void reload_ffp_shaders(SceGxmVertexAttribute *attrs, SceGxmVertexStream *stream
 		}
 	}
 
+	// Counting number of enabled clip planes and lights
+	mask->clip_planes_num = clip_planes_aligned ? clip_plane_range[1] - clip_plane_range[0] : __builtin_popcount(clip_planes_mask);
+	if (lighting_state)
+		mask->lights_num = lights_aligned ? light_range[1] - light_range[0] : __builtin_popcount(light_mask);
+}
+
+void reload_ffp_shaders(SceGxmVertexAttribute *attrs, SceGxmVertexStream *streams) {
+	// Checking if mask changed
+	GLboolean ffp_dirty_frag_blend = ffp_blend_info.raw != blend_info.raw;
+	shader_mask mask;
+#ifndef DISABLE_TEXTURE_COMBINER
+	combiner_mask cmb_mask;
+	build_ffp_mask(attrs, &mask, &cmb_mask);
+#else
+	build_ffp_mask(attrs, &mask);
+#endif
+
 	vector4f *clip_planes;
 	vector4f temp_clip_planes[MAX_CLIP_PLANES_NUM];
-	if (clip_planes_aligned) {
+	if (clip_planes_aligned)
 		clip_planes = &clip_planes_eq[clip_plane_range[0]];
-		mask.clip_planes_num = clip_plane_range[1] - clip_plane_range[0];
-	} else {
+	else {
+		int j = 0;
 		clip_planes = &temp_clip_planes[0];
 		for (int i = clip_plane_range[0]; i < clip_plane_range[1]; i++) {
-			if (clip_planes_mask & (1 << i)) {
-				sceClibMemcpy(&clip_planes[mask.clip_planes_num], &clip_planes_eq[i], sizeof(vector4f));
-				mask.clip_planes_num++;
-			}
+			if (clip_planes_mask & (1 << i))
+				sceClibMemcpy(&clip_planes[j++], &clip_planes_eq[i], sizeof(vector4f));
 		}
 	}
 
 	float *light_vars[MAX_LIGHTS_NUM][5];
-	if (!lighting_state)
-		mask.lights_num = 0;
-	else {
+	if (lighting_state) {
 		if (lights_aligned) {
 			light_vars[0][0] = &lights_ambients[light_range[0]].x;
 			light_vars[0][1] = &lights_diffuses[light_range[0]].x;
 			light_vars[0][2] = &lights_speculars[light_range[0]].x;
 			light_vars[0][3] = &lights_positions[light_range[0]].x;
 			light_vars[0][4] = &lights_attenuations[light_range[0]].x;
-			mask.lights_num = light_range[1] - light_range[0];
 		} else {
+			int j = 0;
 			for (int i = light_range[0]; i < light_range[1]; i++) {
 				if (light_mask & (1 << i)) {
-					light_vars[mask.lights_num][0] = &lights_ambients[i].x;
-					light_vars[mask.lights_num][1] = &lights_diffuses[i].x;
-					light_vars[mask.lights_num][2] = &lights_speculars[i].x;
-					light_vars[mask.lights_num][3] = &lights_positions[i].x;
-					light_vars[mask.lights_num][4] = &lights_attenuations[i].x;
-					mask.lights_num++;
+					light_vars[j][0] = &lights_ambients[i].x;
+					light_vars[j][1] = &lights_diffuses[i].x;
+					light_vars[j][2] = &lights_speculars[i].x;
+					light_vars[j][3] = &lights_positions[i].x;
+					light_vars[j][4] = &lights_attenuations[i].x;
+					j++;
 				}
 			}
 		}
@@ -470,6 +571,9 @@ void reload_ffp_shaders(SceGxmVertexAttribute *attrs, SceGxmVertexStream *stream
 			param = sceGxmProgramFindParameterByName(ffp_vertex_program, "normals");
 			attrs[ffp_vertex_num_params++].regIndex = sceGxmProgramParameterGetResourceIndex(param);
 		}
+		for (int i = 0; i < ffp_vertex_num_params; i++) {
+			streams[i].indexSource = ffp_index_source;
+		}
 	} else { // Non immediate mode
 		// Vertex positions
 		const SceGxmProgramParameter *param = sceGxmProgramFindParameterByName(ffp_vertex_program, "position");
@@ -477,7 +581,7 @@ void reload_ffp_shaders(SceGxmVertexAttribute *attrs, SceGxmVertexStream *stream
 		ffp_vertex_attribute[0].streamIndex = 0;
 		ffp_vertex_attribute[0].regIndex = sceGxmProgramParameterGetResourceIndex(param);
 		ffp_vertex_stream[0].stride = ffp_vertex_stream_config[0].stride;
-		ffp_vertex_stream[0].indexSource = SCE_GXM_INDEX_SOURCE_INDEX_16BIT;
+		ffp_vertex_stream[0].indexSource = ffp_index_source;
 
 		// Vertex texture coordinates (First pass)
 		if (mask.num_textures > 0) {
@@ -486,7 +590,7 @@ void reload_ffp_shaders(SceGxmVertexAttribute *attrs, SceGxmVertexStream *stream
 			ffp_vertex_attribute[1].streamIndex = 1;
 			ffp_vertex_attribute[1].regIndex = sceGxmProgramParameterGetResourceIndex(param);
 			ffp_vertex_stream[1].stride = ffp_vertex_stream_config[texcoord_idxs[0]].stride;
-			ffp_vertex_stream[1].indexSource = SCE_GXM_INDEX_SOURCE_INDEX_16BIT;
+			ffp_vertex_stream[1].indexSource = ffp_index_source;
 			ffp_vertex_num_params++;
 		}
 		
@@ -497,7 +601,7 @@ void reload_ffp_shaders(SceGxmVertexAttribute *attrs, SceGxmVertexStream *stream
 			ffp_vertex_attribute[ffp_vertex_num_params].streamIndex = ffp_vertex_num_params;
 			ffp_vertex_attribute[ffp_vertex_num_params].regIndex = sceGxmProgramParameterGetResourceIndex(param);
 			ffp_vertex_stream[ffp_vertex_num_params].stride = ffp_vertex_stream_config[2].stride;
-			ffp_vertex_stream[ffp_vertex_num_params].indexSource = SCE_GXM_INDEX_SOURCE_INDEX_16BIT;
+			ffp_vertex_stream[ffp_vertex_num_params].indexSource = ffp_index_source;
 			ffp_vertex_num_params++;
 		}
 		
@@ -508,7 +612,7 @@ void reload_ffp_shaders(SceGxmVertexAttribute *attrs, SceGxmVertexStream *stream
 			ffp_vertex_attribute[ffp_vertex_num_params].streamIndex = ffp_vertex_num_params;
 			ffp_vertex_attribute[ffp_vertex_num_params].regIndex = sceGxmProgramParameterGetResourceIndex(param);
 			ffp_vertex_stream[ffp_vertex_num_params].stride = ffp_vertex_stream_config[texcoord_idxs[1]].stride;
-			ffp_vertex_stream[ffp_vertex_num_params].indexSource = SCE_GXM_INDEX_SOURCE_INDEX_16BIT;
+			ffp_vertex_stream[ffp_vertex_num_params].indexSource = ffp_index_source;
 			ffp_vertex_num_params++;
 		}
 		
@@ -673,7 +777,7 @@ void reload_ffp_shaders(SceGxmVertexAttribute *attrs, SceGxmVertexStream *stream
 
 	// Uploading fragment shader uniforms
 	void *buffer;
-	if (dirty_frag_unifs) {
+	if (dirty_frag_unifs || (dirty_tint_color && !mask.has_colors)) {
 		if (vglReserveFragmentUniformBuffer(ffp_fragment_program, &buffer)) {
 			if (ffp_fragment_params[ALPHA_CUT_UNIF])
 				sceGxmSetUniformDataF(buffer, ffp_fragment_params[ALPHA_CUT_UNIF], 0, 1, &alpha_ref);
@@ -694,6 +798,7 @@ void reload_ffp_shaders(SceGxmVertexAttribute *attrs, SceGxmVertexStream *stream
 				sceGxmSetUniformDataF(buffer, ffp_fragment_params[FOG_DENSITY_UNIF], 0, 1, (const float *)&fog_density);
 		}
 		dirty_frag_unifs = GL_FALSE;
+		dirty_tint_color = GL_FALSE;
 	}
 
 	// Uploading vertex shader uniforms
@@ -729,8 +834,44 @@ void reload_ffp_shaders(SceGxmVertexAttribute *attrs, SceGxmVertexStream *stream
 	}
 }
 
+#ifndef DRAW_SPEEDHACK
+static void upload_client_streams(void **ptrs, int *attr_idxs, int attr_num, uint32_t min, uint32_t max) {
+	// Copying interleaved client side arrays (same stride, within a single vertex from the lowest address) only once
+	uint32_t uploaded = 0;
+	for (;;) {
+		int base = -1;
+		for (int i = 0; i < attr_num; i++) {
+			int attr_idx = attr_idxs[i];
+			if (!(uploaded & (1 << i)) && !ffp_vertex_attrib_vbo[attr_idx]) {
+				if (base < 0 || ffp_vertex_attrib_offsets[attr_idx] < ffp_vertex_attrib_offsets[attr_idxs[base]])
+					base = i;
+			}
+		}
+		if (base < 0)
+			break;
+
+		uint32_t base_addr = ffp_vertex_attrib_offsets[attr_idxs[base]];
+		uint32_t stride = ffp_vertex_stream_config[attr_idxs[base]].stride;
+		uint8_t *ptr = upload_vertex_range((void *)base_addr, stride, min, max);
+		for (int i = 0; i < attr_num; i++) {
+			int attr_idx = attr_idxs[i];
+			if (!(uploaded & (1 << i)) && !ffp_vertex_attrib_vbo[attr_idx] && ffp_vertex_stream_config[attr_idx].stride == stride && ffp_vertex_attrib_offsets[attr_idx] - base_addr < stride) {
+				ptrs[i] = ptr + (ffp_vertex_attrib_offsets[attr_idx] - base_addr);
+				uploaded |= (1 << i);
+			}
+		}
+	}
+}
+#endif
+
 void _glDrawArrays_FixedFunctionIMPL(GLsizei count) {
 	reload_ffp_shaders(NULL, NULL);
+	int attr_idxs[FFP_VERTEX_ATTRIBS_NUM] = {0, 0, 0, 0, 0, 0, 0, 0};
+	int attr_num = 0;
+	for (int i = 0; i < FFP_VERTEX_ATTRIBS_NUM; i++) {
+		if (ffp_vertex_attrib_state & (1 << i))
+			attr_idxs[attr_num++] = i;
+	}
 
 	// Uploading textures on relative texture units
 	for (int i = 0; i < ffp_mask.num_textures; i++) {
@@ -738,30 +879,206 @@ void _glDrawArrays_FixedFunctionIMPL(GLsizei count) {
 	}
 
 	// Uploading vertex streams
-	int i, j = 0;
 	void *ptrs[FFP_VERTEX_ATTRIBS_NUM];
-	for (i = 0; i < FFP_VERTEX_ATTRIBS_NUM; i++) {
-		if (ffp_vertex_attrib_state & (1 << i)) {
-			if (ffp_vertex_attrib_vbo[i]) {
-				gpubuffer *gpu_buf = (gpubuffer *)ffp_vertex_attrib_vbo[i];
-				gpu_buf->used = GL_TRUE;
-				ptrs[i] = (uint8_t *)gpu_buf->ptr + ffp_vertex_attrib_offsets[i];
-			} else {
+#ifndef DRAW_SPEEDHACK
+	upload_client_streams(ptrs, attr_idxs, attr_num, 0, count - 1);
+#endif
+	for (int i = 0; i < attr_num; i++) {
+		int attr_idx = attr_idxs[i];
+		if (ffp_vertex_attrib_vbo[attr_idx]) {
+			gpubuffer *gpu_buf = (gpubuffer *)ffp_vertex_attrib_vbo[attr_idx];
+			gpu_buf->used = GL_TRUE;
+			ptrs[i] = (uint8_t *)gpu_buf->ptr + ffp_vertex_attrib_offsets[attr_idx];
+		}
 #ifdef DRAW_SPEEDHACK
-				ptrs[i] = (void *)ffp_vertex_attrib_offsets[i];
+		else
+			ptrs[i] = (void *)ffp_vertex_attrib_offsets[attr_idx];
+#endif
+		sceGxmSetVertexStream(gxm_context, i, ptrs[i]);
+	}
+}
+
+static GLboolean is_ffp_state_unchanged(SceGxmVertexAttribute *attrs) {
+	// Checking if uniforms, blending or sceGxm state changed since last ffp shaders reload
+	if (dirty_vert_unifs || dirty_frag_unifs || (dirty_tint_color && !ffp_mask.has_colors) || mvp_modified || ffp_blend_info.raw != blend_info.raw || vglHasPendingGxmState())
+		return GL_FALSE;
+
+	// Checking if ffp shaders would change
+	shader_mask mask;
+#ifndef DISABLE_TEXTURE_COMBINER
+	combiner_mask cmb_mask;
+	build_ffp_mask(attrs, &mask, &cmb_mask);
+	return mask.raw == ffp_mask.raw && cmb_mask.raw == ffp_combiner_mask.raw;
 #else
-				uint32_t size = count * ffp_vertex_stream_config[i].stride;
-				ptrs[i] = gpu_alloc_mapped_temp(size);
-				sceClibMemcpy(ptrs[i], (void *)ffp_vertex_attrib_offsets[i], size);
+	build_ffp_mask(attrs, &mask);
+	return mask.raw == ffp_mask.raw;
 #endif
-			}
-			sceGxmSetVertexStream(gxm_context, j++, ptrs[i]);
+}
+
+#ifdef HAVE_DRAW_BATCHING
+#define DRAW_BATCH_STREAM_SIZE 0x8000 // Size in bytes of every staging vertex stream used for draw batching
+#define DRAW_BATCH_INDICES_NUM 0x3000 // Max number of indices a batched draw call can hold
+
+static uint8_t draw_batch_streams[FFP_VERTEX_ATTRIBS_NUM][DRAW_BATCH_STREAM_SIZE]; // Staging vertex streams for the pending batched draw
+static uint16_t draw_batch_idx[DRAW_BATCH_INDICES_NUM]; // Staging index buffer for the pending batched draw
+static SceGxmVertexAttribute draw_batch_attribs[FFP_VERTEX_ATTRIBS_NUM]; // Vertex attributes config of the pending batched draw
+static uint16_t draw_batch_strides[FFP_VERTEX_ATTRIBS_NUM]; // Vertex streams strides of the pending batched draw
+static SceGxmTexture draw_batch_textures[TEXTURE_COORDS_NUM]; // Textures used by the pending batched draw
+static uint16_t draw_batch_attrib_state; // Vertex attributes state of the pending batched draw
+static uint32_t draw_batch_vertices = 0; // Number of vertices staged for the pending batched draw
+uint32_t draw_batch_idx_count = 0; // Number of indices staged for the pending batched draw (0 = No pending batch)
+
+static GLboolean is_draw_batch_compatible(void) {
+	if (!is_ffp_state_unchanged(NULL))
+		return GL_FALSE;
+
+	// Checking if vertex attributes layout changed since the batch started
+	if (draw_batch_attrib_state != ffp_vertex_attrib_state)
+		return GL_FALSE;
+	for (int i = 0; i < FFP_VERTEX_ATTRIBS_NUM; i++) {
+		if (ffp_vertex_attrib_state & (1 << i)) {
+			if (draw_batch_strides[i] != ffp_vertex_stream_config[i].stride || sceClibMemcmp(&draw_batch_attribs[i], &ffp_vertex_attrib_config[i], sizeof(SceGxmVertexAttribute)))
+				return GL_FALSE;
 		}
 	}
+
+	// Checking if bound textures changed since the batch started
+	for (int i = 0; i < ffp_mask.num_textures; i++) {
+		if (sceClibMemcmp(&draw_batch_textures[i], &texture_slots[texture_units[i].tex_id].gxm_tex, sizeof(SceGxmTexture)))
+			return GL_FALSE;
+	}
+
+	return GL_TRUE;
 }
 
-void _glDrawElements_FixedFunctionIMPL(uint16_t *idx_buf, GLsizei count) {
-	reload_ffp_shaders(NULL, NULL);
+void flushDrawBatch(void) {
+	// Uploading staged vertex streams
+	int i, j = 0;
+	for (i = 0; i < FFP_VERTEX_ATTRIBS_NUM; i++) {
+		if (draw_batch_attrib_state & (1 << i)) {
+			uint32_t size = draw_batch_vertices * draw_batch_strides[i];
+			void *ptr = gpu_alloc_mapped_temp(size);
+			sceClibMemcpy(ptr, draw_batch_streams[j], size);
+			sceGxmSetVertexStream(gxm_context, j++, ptr);
+		}
+	}
+
+	// Uploading staged indices and performing the draw
+	uint16_t *ptr = gpu_alloc_mapped_temp(draw_batch_idx_count * sizeof(uint16_t));
+	sceClibMemcpy(ptr, draw_batch_idx, draw_batch_idx_count * sizeof(uint16_t));
+	sceGxmDraw(gxm_context, SCE_GXM_PRIMITIVE_TRIANGLES, SCE_GXM_INDEX_FORMAT_U16, ptr, draw_batch_idx_count);
+
+	draw_batch_idx_count = 0;
+	draw_batch_vertices = 0;
+}
+
+GLboolean _glDrawArrays_BatchedIMPL(GLenum mode, GLint first, GLsizei count) {
+	// Checking if the draw call can be batched
+	uint32_t idx_count;
+	switch (mode) {
+	case GL_TRIANGLES:
+		idx_count = count - count % 3;
+		break;
+	case GL_TRIANGLE_STRIP:
+	case GL_TRIANGLE_FAN:
+		idx_count = (count - 2) * 3;
+		break;
+	case GL_QUADS:
+		idx_count = (count / 4) * 6;
+		break;
+	default:
+		return GL_FALSE;
+	}
+	if (!idx_count || idx_count > DRAW_BATCH_INDICES_NUM)
+		return GL_FALSE;
+	int i, j;
+	GLboolean has_room = draw_batch_idx_count + idx_count <= DRAW_BATCH_INDICES_NUM && draw_batch_vertices + count <= 0x10000;
+	for (i = 0; i < FFP_VERTEX_ATTRIBS_NUM; i++) {
+		if (ffp_vertex_attrib_state & (1 << i)) {
+			if (ffp_vertex_attrib_vbo[i] || count * ffp_vertex_stream_config[i].stride > DRAW_BATCH_STREAM_SIZE)
+				return GL_FALSE;
+			if ((draw_batch_vertices + count) * ffp_vertex_stream_config[i].stride > DRAW_BATCH_STREAM_SIZE)
+				has_room = GL_FALSE;
+		}
+	}
+
+	// Emitting the pending batched draw if the new draw call can't be merged into it
+	if (draw_batch_idx_count && (!has_room || !is_draw_batch_compatible()))
+		flushDrawBatch();
+
+	// Starting a new batch with the current state
+	if (!draw_batch_idx_count) {
+		reload_ffp_shaders(NULL, NULL);
+		for (i = 0; i < ffp_mask.num_textures; i++) {
+			sceClibMemcpy(&draw_batch_textures[i], &texture_slots[texture_units[i].tex_id].gxm_tex, sizeof(SceGxmTexture));
+			sceGxmSetFragmentTexture(gxm_context, i, &draw_batch_textures[i]);
+		}
+		for (i = 0; i < FFP_VERTEX_ATTRIBS_NUM; i++) {
+			sceClibMemcpy(&draw_batch_attribs[i], &ffp_vertex_attrib_config[i], sizeof(SceGxmVertexAttribute));
+			draw_batch_strides[i] = ffp_vertex_stream_config[i].stride;
+		}
+		draw_batch_attrib_state = ffp_vertex_attrib_state;
+		vglFlushGxmState();
+	}
+
+	// Staging vertex streams
+	for (i = 0, j = 0; i < FFP_VERTEX_ATTRIBS_NUM; i++) {
+		if (ffp_vertex_attrib_state & (1 << i)) {
+			uint32_t stride = draw_batch_strides[i];
+			sceClibMemcpy(&draw_batch_streams[j++][draw_batch_vertices * stride], (uint8_t *)ffp_vertex_attrib_offsets[i] + first * stride, count * stride);
+		}
+	}
+
+	// Staging indices as a triangle list
+	uint16_t *idx = &draw_batch_idx[draw_batch_idx_count];
+	uint16_t base = draw_batch_vertices;
+	switch (mode) {
+	case GL_TRIANGLES:
+		for (i = 0; i < idx_count; i++) {
+			idx[i] = base + i;
+		}
+		break;
+	case GL_TRIANGLE_STRIP:
+		for (i = 0; i < count - 2; i++) {
+			idx[i * 3] = base + i + (i & 1);
+			idx[i * 3 + 1] = base + i + 1 - (i & 1);
+			idx[i * 3 + 2] = base + i + 2;
+		}
+		break;
+	case GL_TRIANGLE_FAN:
+		for (i = 0; i < count - 2; i++) {
+			idx[i * 3] = base;
+			idx[i * 3 + 1] = base + i + 1;
+			idx[i * 3 + 2] = base + i + 2;
+		}
+		break;
+	case GL_QUADS:
+		for (i = 0; i < count / 4; i++) {
+			idx[i * 6] = base + i * 4;
+			idx[i * 6 + 1] = base + i * 4 + 1;
+			idx[i * 6 + 2] = base + i * 4 + 3;
+			idx[i * 6 + 3] = base + i * 4 + 1;
+			idx[i * 6 + 4] = base + i * 4 + 2;
+			idx[i * 6 + 5] = base + i * 4 + 3;
+		}
+		break;
+	default:
+		break;
+	}
+	draw_batch_idx_count += idx_count;
+	draw_batch_vertices += count;
+
+	return GL_TRUE;
+}
+#endif
+
+void _glDrawElements_FixedFunctionIMPL(void *idx_buf, GLenum idx_type, GLsizei count, const uint32_t *idx_range) {
+	if (idx_type == GL_UNSIGNED_INT) {
+		ffp_index_source = SCE_GXM_INDEX_SOURCE_INDEX_32BIT;
+		reload_ffp_shaders(NULL, NULL);
+		ffp_index_source = SCE_GXM_INDEX_SOURCE_INDEX_16BIT;
+	} else
+		reload_ffp_shaders(NULL, NULL);
 	int attr_idxs[FFP_VERTEX_ATTRIBS_NUM] = {0, 0, 0, 0, 0, 0, 0, 0};
 	int attr_num = 0;
 	GLboolean is_full_vbo = GL_TRUE;
@@ -774,14 +1091,14 @@ void _glDrawElements_FixedFunctionIMPL(uint16_t *idx_buf, GLsizei count) {
 	}
 
 #ifndef DRAW_SPEEDHACK
-	// Detecting highest index value
-	uint32_t top_idx = 0;
+	// Detecting lowest and highest index values
+	uint32_t min_idx, max_idx;
 	if (!is_full_vbo) {
-		for (int i = 0; i < count; i++) {
-			if (idx_buf[i] > top_idx)
-				top_idx = idx_buf[i];
-		}
-		top_idx++;
+		if (idx_range) {
+			min_idx = idx_range[0];
+			max_idx = idx_range[1];
+		} else
+			get_index_range(idx_buf, idx_type, count, &min_idx, &max_idx);
 	}
 #endif
 
@@ -792,21 +1109,21 @@ void _glDrawElements_FixedFunctionIMPL(uint16_t *idx_buf, GLsizei count) {
 
 	// Uploading vertex streams
 	void *ptrs[FFP_VERTEX_ATTRIBS_NUM];
+#ifndef DRAW_SPEEDHACK
+	if (!is_full_vbo)
+		upload_client_streams(ptrs, attr_idxs, attr_num, min_idx, max_idx);
+#endif
 	for (int i = 0; i < attr_num; i++) {
 		int attr_idx = attr_idxs[i];
 		if (ffp_vertex_attrib_vbo[attr_idx]) {
 			gpubuffer *gpu_buf = (gpubuffer *)ffp_vertex_attrib_vbo[attr_idx];
 			gpu_buf->used = GL_TRUE;
 			ptrs[i] = (uint8_t *)gpu_buf->ptr + ffp_vertex_attrib_offsets[attr_idx];
-		} else {
+		}
 #ifdef DRAW_SPEEDHACK
+		else
 			ptrs[i] = (void *)ffp_vertex_attrib_offsets[attr_idx];
-#else
-			uint32_t size = top_idx * ffp_vertex_stream_config[attr_idx].stride;
-			ptrs[i] = gpu_alloc_mapped_temp(size);
-			sceClibMemcpy(ptrs[i], (void *)ffp_vertex_attrib_offsets[attr_idx], size);
 #endif
-		}
 		sceGxmSetVertexStream(gxm_context, i, ptrs[i]);
 	}
 }
@@ -1149,15 +1466,28 @@ void glVertex3f(GLfloat x, GLfloat y, GLfloat z) {
 	}
 #endif
 
+	// Moving the block to a new chunk if the current one is full
+	if (legacy_pool_ptr + legacy_layout_strides[legacy_layout] > legacy_pool_end)
+		grow_legacy_pool(legacy_layout_strides[legacy_layout]);
+
 	legacy_pool_ptr[0] = x;
 	legacy_pool_ptr[1] = y;
 	legacy_pool_ptr[2] = z;
-	if (lighting_state) {
-		sceClibMemcpy(legacy_pool_ptr + 3, &current_vtx.uv.x, sizeof(float) * 2);
+	sceClibMemcpy(legacy_pool_ptr + 3, &current_vtx.uv.x, sizeof(float) * 2);
+	switch (legacy_layout) {
+	case LEGACY_LAYOUT_COMPACT:
+		// Storing color shared by the whole block
+		if (!vertex_count)
+			sceClibMemcpy(&legacy_block_clr, &current_vtx.clr, sizeof(vector4f));
+		break;
+	case LEGACY_LAYOUT_COMPACT_COLOR:
+		*(uint32_t *)&legacy_pool_ptr[5] = legacy_packed_clr;
+		break;
+	default:
 		sceClibMemcpy(legacy_pool_ptr + 5, &current_vtx.amb.x, sizeof(float) * 19);
-	} else
-		sceClibMemcpy(legacy_pool_ptr + 3, &current_vtx.uv.x, sizeof(float) * 6);
-	legacy_pool_ptr += LEGACY_VERTEX_STRIDE;
+		break;
+	}
+	legacy_pool_ptr += legacy_layout_strides[legacy_layout];
 
 	// Increasing vertex counter
 	vertex_count++;
@@ -1209,14 +1539,16 @@ void glColor3f(GLfloat red, GLfloat green, GLfloat blue) {
 	current_vtx.clr.g = green;
 	current_vtx.clr.b = blue;
 	current_vtx.clr.a = 1.0f;
-	dirty_frag_unifs = GL_TRUE;
+	dirty_tint_color = GL_TRUE;
+	track_legacy_color();
 }
 
 void glColor3fv(const GLfloat *v) {
 	// Setting current color value
 	sceClibMemcpy(&current_vtx.clr.r, v, sizeof(vector3f));
 	current_vtx.clr.a = 1.0f;
-	dirty_frag_unifs = GL_TRUE;
+	dirty_tint_color = GL_TRUE;
+	track_legacy_color();
 }
 
 void glColor3ub(GLubyte red, GLubyte green, GLubyte blue) {
@@ -1225,7 +1557,8 @@ void glColor3ub(GLubyte red, GLubyte green, GLubyte blue) {
 	current_vtx.clr.g = (1.0f * green) / 255.0f;
 	current_vtx.clr.b = (1.0f * blue) / 255.0f;
 	current_vtx.clr.a = 1.0f;
-	dirty_frag_unifs = GL_TRUE;
+	dirty_tint_color = GL_TRUE;
+	track_legacy_color();
 }
 
 void glColor3ubv(const GLubyte *c) {
@@ -1234,7 +1567,8 @@ void glColor3ubv(const GLubyte *c) {
 	current_vtx.clr.g = (1.0f * c[1]) / 255.0f;
 	current_vtx.clr.b = (1.0f * c[2]) / 255.0f;
 	current_vtx.clr.a = 1.0f;
-	dirty_frag_unifs = GL_TRUE;
+	dirty_tint_color = GL_TRUE;
+	track_legacy_color();
 }
 
 void glColor4f(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
@@ -1243,13 +1577,15 @@ void glColor4f(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
 	current_vtx.clr.g = green;
 	current_vtx.clr.b = blue;
 	current_vtx.clr.a = alpha;
-	dirty_frag_unifs = GL_TRUE;
+	dirty_tint_color = GL_TRUE;
+	track_legacy_color();
 }
 
 void glColor4fv(const GLfloat *v) {
 	// Setting current color value
 	sceClibMemcpy(&current_vtx.clr.r, v, sizeof(vector4f));
-	dirty_frag_unifs = GL_TRUE;
+	dirty_tint_color = GL_TRUE;
+	track_legacy_color();
 }
 
 void glColor4ub(GLubyte red, GLubyte green, GLubyte blue, GLubyte alpha) {
@@ -1257,7 +1593,8 @@ void glColor4ub(GLubyte red, GLubyte green, GLubyte blue, GLubyte alpha) {
 	current_vtx.clr.g = (1.0f * green) / 255.0f;
 	current_vtx.clr.b = (1.0f * blue) / 255.0f;
 	current_vtx.clr.a = (1.0f * alpha) / 255.0f;
-	dirty_frag_unifs = GL_TRUE;
+	dirty_tint_color = GL_TRUE;
+	track_legacy_color();
 }
 
 void glColor4ubv(const GLubyte *c) {
@@ -1266,7 +1603,8 @@ void glColor4ubv(const GLubyte *c) {
 	current_vtx.clr.g = (1.0f * c[1]) / 255.0f;
 	current_vtx.clr.b = (1.0f * c[2]) / 255.0f;
 	current_vtx.clr.a = (1.0f * c[3]) / 255.0f;
-	dirty_frag_unifs = GL_TRUE;
+	dirty_tint_color = GL_TRUE;
+	track_legacy_color();
 }
 
 void glColor4x(GLfixed red, GLfixed green, GLfixed blue, GLfixed alpha) {
@@ -1282,7 +1620,8 @@ void glColor4x(GLfixed red, GLfixed green, GLfixed blue, GLfixed alpha) {
 	current_vtx.clr.g = (1.0f * green) / 65536.0f;
 	current_vtx.clr.b = (1.0f * blue) / 65536.0f;
 	current_vtx.clr.a = (1.0f * alpha) / 65536.0f;
-	dirty_frag_unifs = GL_TRUE;
+	dirty_tint_color = GL_TRUE;
+	track_legacy_color();
 }
 
 void glNormal3f(GLfloat x, GLfloat y, GLfloat z) {
@@ -1331,6 +1670,61 @@ void glTexCoord2i(GLint s, GLint t) {
 	glTexCoord2f(s, t);
 }
 
+static GLboolean can_merge_legacy_draw(uint32_t count) {
+	// Checking if block vertices are contiguous to the pending draw ones
+	if (legacy_draw_ptr + legacy_draw_count * legacy_layout_strides[legacy_draw_layout] != legacy_pool)
+		return GL_FALSE;
+
+	// Only primitives using progressive indices can be merged
+	switch (legacy_draw_mode) {
+	case GL_POINTS:
+	case GL_LINES:
+	case GL_TRIANGLES:
+		return legacy_draw_count + count <= MAX_IDX_NUMBER;
+	case GL_QUADS:
+		return ((legacy_draw_count + count) / 2) * 3 <= MAX_IDX_NUMBER;
+	default:
+		return GL_FALSE;
+	}
+}
+
+void flushLegacyDraw(void) {
+	// Uploading vertex streams
+	for (int i = 0; i < legacy_draw_streams_num; i++) {
+		sceGxmSetVertexStream(gxm_context, i, legacy_draw_ptr);
+	}
+
+	uint16_t *ptr;
+	uint32_t index_count;
+
+	// Get the index source
+	switch (legacy_draw_mode) {
+	case GL_QUADS:
+		ptr = default_quads_idx_ptr;
+		index_count = (legacy_draw_count / 2) * 3;
+		break;
+	case GL_LINE_STRIP:
+		ptr = default_line_strips_idx_ptr;
+		index_count = (legacy_draw_count - 1) * 2;
+		break;
+	case GL_LINE_LOOP:
+		ptr = gpu_alloc_mapped_temp(legacy_draw_count * 2 * sizeof(uint16_t));
+		sceClibMemcpy(ptr, default_line_strips_idx_ptr, (legacy_draw_count - 1) * 2 * sizeof(uint16_t));
+		ptr[(legacy_draw_count - 1) * 2] = legacy_draw_count - 1;
+		ptr[(legacy_draw_count - 1) * 2 + 1] = 0;
+
+		index_count = legacy_draw_count * 2;
+		break;
+	default:
+		ptr = default_idx_ptr;
+		index_count = legacy_draw_count;
+		break;
+	}
+
+	sceGxmDraw(gxm_context, legacy_draw_prim, SCE_GXM_INDEX_FORMAT_U16, ptr, index_count);
+	legacy_draw_count = 0;
+}
+
 void glBegin(GLenum mode) {
 #ifndef SKIP_ERROR_HANDLING
 	// Error handling
@@ -1347,6 +1741,14 @@ void glBegin(GLenum mode) {
 
 	// Resetting vertex count
 	vertex_count = 0;
+
+	// Making sure the immediate mode mempool belongs to the current frame
+	sceneBeginFrame();
+
+	// Starting with the smallest vertex layout, lighting requires per vertex materials and normals
+	legacy_layout = lighting_state ? LEGACY_LAYOUT_FULL : LEGACY_LAYOUT_COMPACT;
+	legacy_pool_ptr = legacy_pool;
+	is_legacy_block = GL_TRUE;
 }
 
 void glEnd(void) {
@@ -1360,70 +1762,89 @@ void glEnd(void) {
 	// Changing current openGL machine state
 	phase = NONE;
 #endif
+	is_legacy_block = GL_FALSE;
+
+	// Skipping empty blocks before a scene gets started for them
+	if (!vertex_count)
+		return;
 
 	// Translating primitive to sceGxm one
 	gl_primitive_to_gxm(ffp_mode, prim, vertex_count);
 
 	sceneReset();
+	flush_draw_batch();
+
+	// Setting up vertex attributes for the block vertex layout
+	for (int i = 0; i < FFP_VERTEX_ATTRIBS_NUM; i++) {
+		legacy_vertex_stream_config[i].stride = sizeof(float) * legacy_layout_strides[legacy_layout];
+	}
+	legacy_vertex_attrib_config[2].format = legacy_layout == LEGACY_LAYOUT_COMPACT_COLOR ? SCE_GXM_ATTRIBUTE_FORMAT_U8N : SCE_GXM_ATTRIBUTE_FORMAT_F32;
 
 	// Invalidating current attributes state settings
 	uint8_t orig_state = ffp_vertex_attrib_state;
-	ffp_vertex_attrib_state = 0x07;
-	ffp_dirty_frag = GL_TRUE;
-	ffp_dirty_vert = GL_TRUE;
-	reload_ffp_shaders(legacy_vertex_attrib_config, legacy_vertex_stream_config);
-
-	// Uploading texture to use
-	sceGxmSetFragmentTexture(gxm_context, 0, &texture_slots[texture_units[0].tex_id].gxm_tex);
+	ffp_vertex_attrib_state = legacy_layout == LEGACY_LAYOUT_COMPACT ? 0x03 : 0x07;
 
-	// Restoring original attributes state settings
-	ffp_vertex_attrib_state = orig_state;
+	// Checking if the pending immediate mode draw has been performed with the same state
+	GLboolean is_state_unchanged = legacy_draw_count && legacy_draw_layout == legacy_layout &&
+		is_ffp_state_unchanged(legacy_vertex_attrib_config) &&
+		!sceClibMemcmp(&legacy_draw_texture, &texture_slots[texture_units[0].tex_id].gxm_tex, sizeof(SceGxmTexture));
 
-	// Uploading vertex streams and performing the draw
-	int i;
-	for (i = 0; i < ffp_vertex_num_params; i++) {
-		sceGxmSetVertexStream(gxm_context, i, legacy_pool);
-	}
+	if (is_state_unchanged && legacy_draw_mode == ffp_mode && can_merge_legacy_draw(vertex_count)) {
+		// Merging the block into the pending immediate mode draw
+		legacy_draw_count += vertex_count;
+	} else {
+		flush_legacy_draw();
 
-	// Restoring original attributes state settings
-	ffp_vertex_attrib_state = orig_state;
+		// Reloading shaders and state only if something changed since last block
+		if (!is_state_unchanged) {
+			ffp_dirty_frag = GL_TRUE;
+			ffp_dirty_vert = GL_TRUE;
+			reload_ffp_shaders(legacy_vertex_attrib_config, legacy_vertex_stream_config);
 
-	uint16_t *ptr;
-	uint32_t index_count;
+			// Uploading texture to use
+			sceClibMemcpy(&legacy_draw_texture, &texture_slots[texture_units[0].tex_id].gxm_tex, sizeof(SceGxmTexture));
+			sceGxmSetFragmentTexture(gxm_context, 0, &legacy_draw_texture);
 
-	// Get the index source
-	switch (ffp_mode) {
-	case GL_QUADS:
-		ptr = default_quads_idx_ptr;
-		index_count = (vertex_count / 2) * 3;
-		break;
-	case GL_LINE_STRIP:
-		ptr = default_line_strips_idx_ptr;
-		index_count = (vertex_count - 1) * 2;
-		break;
-	case GL_LINE_LOOP:
-		ptr = gpu_alloc_mapped_temp(vertex_count * 2 * sizeof(uint16_t));
-		sceClibMemcpy(ptr, default_line_strips_idx_ptr, (vertex_count - 1) * 2 * sizeof(uint16_t));
-		ptr[(vertex_count - 1) * 2] = vertex_count - 1;
-		ptr[(vertex_count - 1) * 2 + 1] = 0;
+			vglFlushGxmState();
+			legacy_draw_streams_num = ffp_vertex_num_params;
+			legacy_draw_layout = legacy_layout;
+		}
 
-		index_count = vertex_count * 2;
-		break;
-	default:
-		ptr = default_idx_ptr;
-		index_count = vertex_count;
-		break;
+		// Starting a new pending immediate mode draw
+		legacy_draw_ptr = legacy_pool;
+		legacy_draw_mode = ffp_mode;
+		legacy_draw_prim = prim;
+		legacy_draw_count = vertex_count;
 	}
 
-	sceGxmDraw(gxm_context, prim, SCE_GXM_INDEX_FORMAT_U16, ptr, index_count);
+	// Restoring original attributes state settings
+	ffp_vertex_attrib_state = orig_state;
 
 	// Moving legacy pool address offset
-	legacy_pool += vertex_count * LEGACY_VERTEX_STRIDE;
+	uint32_t block_size = vertex_count * legacy_layout_strides[legacy_layout];
+	legacy_pool += block_size;
+
+	// Updating immediate mode mempool usage stats
+	legacy_pool_usage += block_size * sizeof(float);
+	if (legacy_pool_usage > legacy_pool_peak)
+		legacy_pool_peak = legacy_pool_usage;
 
 	// Restore polygon mode if a GL_LINES/GL_POINTS has been rendered
 	restore_polygon_mode(prim);
 }
 
+void vglGetLegacyPoolStats(uint32_t *peak_usage, uint32_t *extra_chunks) {
+	if (peak_usage)
+		*peak_usage = legacy_pool_peak;
+	if (extra_chunks)
+		*extra_chunks = legacy_pool_chunks;
+}
+
+void vglResetLegacyPoolStats(void) {
+	legacy_pool_peak = legacy_pool_usage;
+	legacy_pool_chunks = 0;
+}
+
 void glTexEnvf(GLenum target, GLenum pname, GLfloat param) {
 	// Aliasing texture unit for cleaner code
 	texture_unit *tex_unit = &texture_units[server_texture_unit];
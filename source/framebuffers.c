@@ -23,9 +23,6 @@
 
 #include "shared.h"
 
-extern void *gxm_color_surfaces_addr[DISPLAY_MAX_BUFFER_COUNT]; // Display color surfaces memblock starting addresses
-extern unsigned int gxm_back_buffer_index; // Display back buffer id
-
 static framebuffer framebuffers[BUFFERS_NUM]; // Framebuffers array
 static renderbuffer renderbuffers[BUFFERS_NUM]; // Renderbuffers array
 
@@ -33,6 +30,104 @@ framebuffer *active_read_fb = NULL; // Current readback framebuffer in use
 framebuffer *active_write_fb = NULL; // Current write framebuffer in use
 renderbuffer *active_rb = NULL; // Current renderbuffer in use
 
+// Color surface description used by transfer jobs
+typedef struct {
+	void *addr;
+	int stride;
+	int width;
+	int height;
+	SceGxmTransferFormat format;
+	SceGxmSyncObject *sync;
+	GLboolean top_down;
+} transfer_surface;
+
+static GLboolean get_transfer_surface(framebuffer *fb, transfer_surface *s) {
+	if (fb) {
+		// Only texture backed color attachments with a transfer equivalent format can be accessed by transfer jobs
+		if (!fb->tex)
+			return GL_FALSE;
+		SceGxmTextureFormat tex_format = sceGxmTextureGetFormat(&fb->tex->gxm_tex);
+		if (!tex_format_has_transfer(tex_format))
+			return GL_FALSE;
+		s->addr = fb->data;
+		s->stride = fb->stride;
+		s->width = fb->width;
+		s->height = fb->height;
+		s->format = tex_format_to_transfer(tex_format);
+		s->sync = NULL;
+#ifdef HAVE_UNFLIPPED_FBOS
+		s->top_down = GL_TRUE;
+#else
+		s->top_down = GL_FALSE;
+#endif
+	} else {
+		getDefaultColorSurface(&s->addr, &s->width, &s->height, &s->sync);
+		s->stride = DISPLAY_STRIDE * 4;
+		s->format = SCE_GXM_TRANSFER_FORMAT_U8U8U8U8_ABGR;
+		s->top_down = GL_TRUE;
+	}
+	return GL_TRUE;
+}
+
+static void clip_default_rect(int surface_width, int surface_height, int *x, int *y, int *w, int *h) {
+	// Default framebuffer is addressed in display space even when its color surface is downscaled by dynamic resolution
+	int x0 = min(max(*x, 0), DISPLAY_WIDTH);
+	int y0 = min(max(*y, 0), DISPLAY_HEIGHT);
+	int x1 = min(max(*x + *w, x0), DISPLAY_WIDTH);
+	int y1 = min(max(*y + *h, y0), DISPLAY_HEIGHT);
+	*x = x0 * surface_width / DISPLAY_WIDTH;
+	*y = y0 * surface_height / DISPLAY_HEIGHT;
+	*w = x1 * surface_width / DISPLAY_WIDTH - *x;
+	*h = y1 * surface_height / DISPLAY_HEIGHT - *y;
+}
+
+static GLboolean transfer_color(transfer_surface *src, int sx, int sy, int sw, int sh, transfer_surface *dst, int dx, int dy, int dw, int dh, GLboolean flip) {
+	/*
+	 * sceGxmTransfer can only perform 1:1 copies or 2x2 box filtered
+	 * downscales, anything else needs to go through a draw call
+	 */
+	GLboolean is_copy = sw == dw && sh == dh;
+	if (!is_copy && (flip || sw != dw * 2 || sh != dh * 2))
+		return GL_FALSE;
+
+	// Converting GL bottom-up coordinates to memory rows
+	int src_row = src->top_down ? (src->height - sy - sh) : sy;
+	int dst_row = dst->top_down ? (dst->height - dy - dh) : dy;
+	if (src->top_down != dst->top_down)
+		flip = !flip;
+	if (!is_copy && flip)
+		return GL_FALSE;
+
+	// Ending current scene so that the transfer job is scheduled after its rendering
+	sceneInterrupt();
+
+	if (is_copy) {
+		// Vertical flipping is performed by walking the source surface backwards
+		uint8_t *src_addr = (uint8_t *)src->addr;
+		int src_stride = src->stride;
+		if (flip) {
+			src_addr += (src_row + sh - 1) * src_stride;
+			src_stride = -src_stride;
+			src_row = 0;
+		}
+		sceGxmTransferCopy(
+			dw, dh, 0, 0, SCE_GXM_TRANSFER_COLORKEY_NONE,
+			src->format, SCE_GXM_TRANSFER_LINEAR,
+			src_addr, sx, src_row, src_stride,
+			dst->format, SCE_GXM_TRANSFER_LINEAR,
+			dst->addr, dx, dst_row, dst->stride,
+			dst->sync, SCE_GXM_TRANSFER_FRAGMENT_SYNC | SCE_GXM_TRANSFER_VERTEX_SYNC, NULL);
+	} else {
+		sceGxmTransferDownscale(
+			src->format, src->addr, sx, src_row,
+			sw, sh, src->stride,
+			dst->format, dst->addr, dx, dst_row,
+			dst->stride,
+			dst->sync, SCE_GXM_TRANSFER_FRAGMENT_SYNC | SCE_GXM_TRANSFER_VERTEX_SYNC, NULL);
+	}
+	return GL_TRUE;
+}
+
 uint32_t get_color_from_texture(uint32_t type) {
 	uint32_t res = 0;
 	switch (type) {
@@ -132,10 +227,8 @@ void glDeleteFramebuffers(GLsizei n, const GLuint *ids) {
 			}
 			if (fb->target)
 				markRtAsDirty(fb->target);
-			if (fb->depth_buffer_addr) {
-				markAsDirty(fb->depth_buffer_addr);
-				markAsDirty(fb->stencil_buffer_addr);
-			}
+			if (fb->depth_buffer_addr)
+				freeDepthStencilBuffer(fb->depth_buffer_addr, fb->stencil_buffer_addr);
 		}
 	}
 }
@@ -158,11 +251,8 @@ void glDeleteRenderbuffers(GLsizei n, const GLuint *ids) {
 				active_rb = NULL;
 
 			fb->active = GL_FALSE;
-			if (fb->depth_buffer_addr) {
-				markAsDirty(fb->depth_buffer_addr);
-				if (fb->stencil_buffer_addr)
-					markAsDirty(fb->stencil_buffer_addr);
-			}
+			if (fb->depth_buffer_addr)
+				freeDepthStencilBuffer(fb->depth_buffer_addr, fb->stencil_buffer_addr);
 		}
 	}
 }
@@ -226,7 +316,7 @@ void glFramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbu
 	}
 }
 
-void glRenderbufferStorage(GLenum target, GLenum internalformat, GLsizei width, GLsizei height) {
+static void renderbuffer_storage(GLenum target, GLenum internalformat, GLsizei width, GLsizei height, GLboolean is_transient) {
 #ifndef SKIP_ERROR_HANDLING
 	if (target != GL_RENDERBUFFER)
 		SET_GL_ERROR(GL_INVALID_ENUM)
@@ -235,25 +325,42 @@ void glRenderbufferStorage(GLenum target, GLenum internalformat, GLsizei width,
 #endif
 	
 	if (active_rb->depth_buffer_addr) {
-		markAsDirty(active_rb->depth_buffer_addr);
-		if (active_rb->stencil_buffer_addr)
-			markAsDirty(active_rb->stencil_buffer_addr);
+		freeDepthStencilBuffer(active_rb->depth_buffer_addr, active_rb->stencil_buffer_addr);
+		active_rb->depth_buffer_addr = NULL;
+		active_rb->stencil_buffer_addr = NULL;
 	}
 	
 	// FIXME: We use mask update bit for scissoring, would be cool to find an alternative to support more formats
 	switch (internalformat) {
 	case GL_DEPTH32F_STENCIL8:
-		initDepthStencilBuffer(width, height, &active_rb->depthbuffer, &active_rb->depth_buffer_addr, &active_rb->stencil_buffer_addr);
+		if (is_transient)
+			initTransientDepthStencilBuffer(width, height, &active_rb->depthbuffer, &active_rb->depth_buffer_addr, &active_rb->stencil_buffer_addr);
+		else
+			initDepthStencilBuffer(width, height, &active_rb->depthbuffer, &active_rb->depth_buffer_addr, &active_rb->stencil_buffer_addr);
 		break;
 	case GL_DEPTH_COMPONENT32F:
-		initDepthStencilBuffer(width, height, &active_rb->depthbuffer, &active_rb->depth_buffer_addr, NULL);
+		if (is_transient)
+			initTransientDepthStencilBuffer(width, height, &active_rb->depthbuffer, &active_rb->depth_buffer_addr, NULL);
+		else
+			initDepthStencilBuffer(width, height, &active_rb->depthbuffer, &active_rb->depth_buffer_addr, NULL);
 		break;
 	default:
 		SET_GL_ERROR(GL_INVALID_ENUM)
 		break;
 	}
+	active_rb->depthbuffer_ptr = &active_rb->depthbuffer;
 
-	sceGxmDepthStencilSurfaceSetForceStoreMode(&active_rb->depthbuffer, SCE_GXM_DEPTH_STENCIL_FORCE_STORE_ENABLED);
+	// Transient renderbuffers content is discarded at scene end, so it's never stored to memory
+	if (!is_transient)
+		sceGxmDepthStencilSurfaceSetForceStoreMode(&active_rb->depthbuffer, SCE_GXM_DEPTH_STENCIL_FORCE_STORE_ENABLED);
+}
+
+void glRenderbufferStorage(GLenum target, GLenum internalformat, GLsizei width, GLsizei height) {
+	renderbuffer_storage(target, internalformat, width, height, GL_FALSE);
+}
+
+void vglRenderbufferStorageTransient(GLenum target, GLenum internalformat, GLsizei width, GLsizei height) {
+	renderbuffer_storage(target, internalformat, width, height, GL_TRUE);
 }
 
 void glFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint tex_id, GLint level) {
@@ -325,7 +432,7 @@ void glFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget,
 
 		// Allocating temporary depth and stencil buffers (if necessary) to ensure scissoring works
 		if (!fb->depth_buffer_addr) {
-			initDepthStencilBuffer(fb->width, fb->height, &fb->depthbuffer, &fb->depth_buffer_addr, &fb->stencil_buffer_addr);
+			initTransientDepthStencilBuffer(fb->width, fb->height, &fb->depthbuffer, &fb->depth_buffer_addr, &fb->stencil_buffer_addr);
 			if (!fb->depthbuffer_ptr)
 				fb->depthbuffer_ptr = &fb->depthbuffer;
 		}
@@ -393,9 +500,13 @@ void glReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format
 		stride = active_read_fb->stride;
 		y = (active_read_fb->height - (height + y)) * stride;
 	} else {
-		src = (uint8_t *)gxm_color_surfaces_addr[gxm_back_buffer_index];
+		int surface_width, surface_height;
+		getDefaultColorSurface((void **)&src, &surface_width, &surface_height, NULL);
+		clip_default_rect(surface_width, surface_height, &x, &y, &width, &height);
+		if (!width || !height)
+			return;
 		stride = DISPLAY_STRIDE * 4;
-		y = (DISPLAY_HEIGHT - (height + y)) * stride;
+		y = (surface_height - (height + y)) * stride;
 		src_bpp = 4;
 		if (format == GL_RGBA)
 			fast_store = GL_TRUE;
@@ -464,6 +575,123 @@ void glReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format
 	}
 }
 
+void glBlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter) {
+#ifndef SKIP_ERROR_HANDLING
+	if (mask & ~(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT)) {
+		SET_GL_ERROR(GL_INVALID_VALUE)
+	} else if (filter != GL_NEAREST && filter != GL_LINEAR) {
+		SET_GL_ERROR(GL_INVALID_ENUM)
+	}
+#endif
+
+	// Depth and stencil surfaces can't be blitted with sceGxmTransfer, so we only handle color
+	if (!(mask & GL_COLOR_BUFFER_BIT))
+		return;
+
+	transfer_surface src, dst;
+	if (!get_transfer_surface(active_read_fb, &src) || !get_transfer_surface(active_write_fb, &dst)) {
+		SET_GL_ERROR(GL_INVALID_OPERATION)
+	}
+
+	// Normalizing rectangles, vertical mirroring is handled by the transfer job
+	GLboolean flip = (srcY1 < srcY0) != (dstY1 < dstY0);
+	int sx = min(srcX0, srcX1);
+	int sy = min(srcY0, srcY1);
+	int sw = abs(srcX1 - srcX0);
+	int sh = abs(srcY1 - srcY0);
+	int dx = min(dstX0, dstX1);
+	int dy = min(dstY0, dstY1);
+	int dw = abs(dstX1 - dstX0);
+	int dh = abs(dstY1 - dstY0);
+	if (!active_read_fb)
+		clip_default_rect(src.width, src.height, &sx, &sy, &sw, &sh);
+	if (!active_write_fb)
+		clip_default_rect(dst.width, dst.height, &dx, &dy, &dw, &dh);
+
+#ifndef SKIP_ERROR_HANDLING
+	if ((srcX1 < srcX0) != (dstX1 < dstX0)) {
+		SET_GL_ERROR(GL_INVALID_OPERATION)
+	} else if (sx < 0 || sy < 0 || sx + sw > src.width || sy + sh > src.height) {
+		SET_GL_ERROR(GL_INVALID_VALUE)
+	} else if (dx < 0 || dy < 0 || dx + dw > dst.width || dy + dh > dst.height) {
+		SET_GL_ERROR(GL_INVALID_VALUE)
+	}
+#endif
+
+	if (!sw || !sh)
+		return;
+
+	if (!transfer_color(&src, sx, sy, sw, sh, &dst, dx, dy, dw, dh, flip)) {
+		SET_GL_ERROR(GL_INVALID_OPERATION)
+	}
+
+	// Marking the destination as in use like a draw would, so that blits to the display get presented
+	in_use_framebuffer = active_write_fb;
+	is_rendering_display = !active_write_fb;
+}
+
+void glCopyTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint x, GLint y, GLsizei width, GLsizei height) {
+	// Setting some aliases to make code more readable
+	texture_unit *tex_unit = &texture_units[server_texture_unit];
+	int texture2d_idx = tex_unit->tex_id;
+	texture *tex = &texture_slots[texture2d_idx];
+
+#ifndef SKIP_ERROR_HANDLING
+	if (target != GL_TEXTURE_2D) {
+		SET_GL_ERROR(GL_INVALID_ENUM)
+	} else if (level != 0 || width < 0 || height < 0) {
+		SET_GL_ERROR(GL_INVALID_VALUE)
+	} else if (tex->status != TEX_VALID) {
+		SET_GL_ERROR(GL_INVALID_OPERATION)
+	}
+#endif
+
+	transfer_surface src, dst;
+	if (!get_transfer_surface(active_read_fb, &src)) {
+		SET_GL_ERROR(GL_INVALID_OPERATION)
+	}
+
+	// Textures are stored bottom-up like non flipped framebuffers
+	SceGxmTextureFormat tex_format = sceGxmTextureGetFormat(&tex->gxm_tex);
+	if (!tex_format_has_transfer(tex_format)) {
+		SET_GL_ERROR(GL_INVALID_OPERATION)
+	}
+	dst.width = vglGetTexWidth(&tex->gxm_tex);
+	dst.height = vglGetTexHeight(&tex->gxm_tex);
+	dst.stride = ALIGN(dst.width, 8) * tex_format_to_bytespp(tex_format);
+	dst.addr = tex->data;
+	dst.format = tex_format_to_transfer(tex_format);
+	dst.sync = NULL;
+	dst.top_down = GL_FALSE;
+	if (!active_read_fb)
+		clip_default_rect(src.width, src.height, &x, &y, &width, &height);
+
+#ifndef SKIP_ERROR_HANDLING
+	if (x < 0 || y < 0 || x + width > src.width || y + height > src.height) {
+		SET_GL_ERROR(GL_INVALID_VALUE)
+	} else if (xoffset < 0 || yoffset < 0 || xoffset + width > dst.width || yoffset + height > dst.height) {
+		SET_GL_ERROR(GL_INVALID_VALUE)
+	}
+#endif
+
+	if (!width || !height)
+		return;
+
+	transfer_color(&src, x, y, width, height, &dst, xoffset, yoffset, width, height, GL_FALSE);
+}
+
+void glCopyTexImage2D(GLenum target, GLint level, GLenum internalformat, GLint x, GLint y, GLsizei width, GLsizei height, GLint border) {
+#ifndef SKIP_ERROR_HANDLING
+	if (border != 0) {
+		SET_GL_ERROR(GL_INVALID_VALUE)
+	}
+#endif
+
+	// Allocating texture storage and filling it with a transfer job
+	glTexImage2D(target, level, internalformat, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	glCopyTexSubImage2D(target, level, 0, 0, x, y, width, height);
+}
+
 /* vgl* */
 
 void vglTexImageDepthBuffer(GLenum target) {
@@ -246,6 +246,12 @@ void glGetIntegerv(GLenum pname, GLint *data) {
 		break;
 	case GL_SHADER_BINARY_FORMATS:
 		break;
+	case GL_NUM_PROGRAM_BINARY_FORMATS:
+		*data = 1;
+		break;
+	case GL_PROGRAM_BINARY_FORMATS:
+		*data = GL_SGX_PROGRAM_BINARY_IMG;
+		break;
 	case GL_FRAMEBUFFER_BINDING:
 		*data = (GLint)active_write_fb;
 		break;
@@ -282,6 +288,12 @@ void glGetIntegerv(GLenum pname, GLint *data) {
 	case GL_MAX_TEXTURE_COORDS:
 		*data = TEXTURE_COORDS_NUM;
 		break;
+	case GL_MAX_UNIFORM_BUFFER_BINDINGS:
+		*data = UNIFORM_BUFFERS_NUM;
+		break;
+	case GL_UNIFORM_BUFFER_BINDING:
+		*data = (GLint)uniform_buffer_unit;
+		break;
 	default:
 		SET_GL_ERROR(GL_INVALID_ENUM)
 	}
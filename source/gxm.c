@@ -22,6 +22,8 @@
  */
 
 #include "shared.h"
+#include "shaders/upscale_f.h"
+#include "shaders/upscale_v.h"
 
 // FIXME: Since we use our own default uniform buffers circular pool, fragment and vertex buffer rings can likely be reduced in size
 static uint32_t gxm_param_buf_size = SCE_GXM_DEFAULT_PARAMETER_BUFFER_SIZE; // Param buffer size for sceGxm
@@ -39,7 +41,7 @@ static SceGxmRenderTarget *gxm_render_target; // Display render target
 static SceGxmColorSurface gxm_color_surfaces[DISPLAY_MAX_BUFFER_COUNT]; // Display color surfaces
 static uint8_t gxm_display_buffer_count = DISPLAY_MAX_BUFFER_COUNT; // Default display buffer count
 void *gxm_color_surfaces_addr[DISPLAY_MAX_BUFFER_COUNT]; // Display color surfaces memblock starting addresses
-static SceGxmSyncObject *gxm_sync_objects[DISPLAY_MAX_BUFFER_COUNT]; // Display sync objects
+SceGxmSyncObject *gxm_sync_objects[DISPLAY_MAX_BUFFER_COUNT]; // Display sync objects
 unsigned int gxm_front_buffer_index; // Display front buffer id
 unsigned int gxm_back_buffer_index; // Display back buffer id
 
@@ -57,6 +59,91 @@ framebuffer *in_use_framebuffer = NULL; // Currently in use framebuffer
 framebuffer *old_framebuffer = NULL; // Framebuffer used in last scene
 static GLboolean needs_end_scene = GL_FALSE; // Flag for gxm end scene requirement at scene reset
 static GLboolean needs_scene_reset = GL_TRUE; // Flag for when a scene reset is required
+static GLboolean is_scene_interrupted = GL_FALSE; // Flag for when current frame started but no gxm scene is currently running
+static uint32_t frame_scenes = 0; // Number of gxm scenes started in current frame
+static uint32_t last_frame_scenes = 0; // Number of gxm scenes started in last completed frame
+static uint32_t peak_frame_scenes = 0; // Highest number of gxm scenes started in a single frame
+
+#define DYNRES_SCALE_STEPS 16 // Number of steps the dynamic resolution scale is quantized to
+#define DYNRES_UPDATE_RATIO 8 // Minimum number of frames between two dynamic resolution scale changes
+static GLboolean dynres_requested = GL_FALSE; // Dynamic resolution mode state requested by the application
+static GLboolean dynres_enabled = GL_FALSE; // Dynamic resolution mode state for the current frame
+static uint32_t dynres_min_steps = DYNRES_SCALE_STEPS / 2; // Minimum scale allowed for dynamic resolution, in steps
+static uint32_t dynres_max_steps = DYNRES_SCALE_STEPS; // Maximum scale allowed for dynamic resolution, in steps
+static uint32_t dynres_steps = DYNRES_SCALE_STEPS; // Current scale for dynamic resolution, in steps
+static uint32_t dynres_target_time = 16666; // Target GPU frame time in microseconds for dynamic resolution
+static uint32_t dynres_frames_since_update = 0; // Number of frames since last dynamic resolution scale change
+static uint32_t dynres_width, dynres_height; // Dynamic resolution render target size in pixels
+static void *dynres_color_addr = NULL; // Dynamic resolution color surface memblock starting address
+static SceGxmColorSurface dynres_color_surface; // Dynamic resolution color surface
+static render_target *dynres_rt = NULL; // Dynamic resolution render target
+static SceGxmTexture dynres_tex; // Dynamic resolution color surface sampled by the upscale pass
+static SceGxmProgram *upscale_vertex_program = NULL; // Compiled vertex program for the upscale pass
+static SceGxmProgram *upscale_fragment_program = NULL; // Compiled fragment program for the upscale pass
+static SceGxmShaderPatcherId upscale_vertex_id, upscale_fragment_id; // Upscale pass shaders ids
+static SceGxmVertexProgram *upscale_vertex_program_patched = NULL; // Patched vertex program for the upscale pass
+static SceGxmFragmentProgram *upscale_fragment_program_patched = NULL; // Patched fragment program for the upscale pass
+
+#define TIMINGS_FRAMES_NUM 4 // Number of in flight frames tracked by GPU timings
+#define TIMINGS_POLL_DELAY 250 // Delay in microseconds between two GPU notifications polls
+#define RENDER_NOTIFICATION 0 // Notification region slot signaled when a frame has been rendered
+#define PRESENT_NOTIFICATION 1 // Notification region slot signaled when a frame has been upscaled to the display
+typedef struct {
+	uint64_t submit_time;
+	uint32_t id;
+	uint32_t query_marker;
+	uint32_t buffer_idx;
+	GLboolean has_render_notification;
+	GLboolean has_present_notification;
+} frame_timings;
+static GLboolean frame_timings_enabled = GL_FALSE; // Flag for GPU timings tracking on current frame
+static SceUID timings_sema, timings_thread = 0; // GPU timings thread
+static uint64_t frame_submit_time = 0; // Time the current frame got first submitted to the GPU
+static uint32_t frame_query_marker = 0; // Timer queries marker signaling the completion of the current frame (if any)
+static frame_timings timings_list[TIMINGS_FRAMES_NUM]; // GPU timings data for in flight frames
+static volatile uint32_t timed_frames = 0; // Number of frames submitted to the GPU timings thread
+static volatile uint64_t display_release_time[DISPLAY_MAX_BUFFER_COUNT]; // Time display color surfaces got released by the display queue
+static volatile uint32_t gpu_frame_time = 0; // Smoothed GPU frame time in microseconds
+static volatile uint32_t last_gpu_frame_time = 0; // GPU frame time in microseconds of last timed frame
+
+#define QUERIES_NUM 64 // Maximum amount of query objects usable
+#define QUERY_MARKERS_NUM 256 // Number of GPU timer queries markers whose timings are retained
+#define QUERY_NOTIFICATION 2 // Notification region slot signaled when a timer queries marker has been reached
+typedef struct {
+	GLboolean active;
+	GLenum target;
+	uint32_t start_marker;
+	uint32_t end_marker;
+	uint64_t submit_time;
+	uint64_t result;
+	GLboolean has_result;
+} query_object;
+static query_object queries[QUERIES_NUM]; // Query objects array
+static query_object *active_time_query = NULL; // Currently running GL_TIME_ELAPSED query
+static GLboolean needs_query_marker = GL_FALSE; // Flag for timer queries marker requirement at next scene end
+static SceUID queries_sema, queries_thread = 0; // GPU timer queries thread
+static volatile uint64_t marker_times[QUERY_MARKERS_NUM]; // Time timer queries markers got reached by the GPU
+static volatile uint32_t query_markers = 0; // Number of timer queries markers submitted to the GPU
+static volatile uint32_t reached_markers = 0; // Number of timer queries markers reached by the GPU
+static volatile GLboolean stop_gpu_timers = GL_FALSE; // Flag for GPU timings and timer queries threads termination
+
+#define VBLANK_TIME 16683 // Time in microseconds between two vblanks
+#define PACING_DECREASE_FRAMES 60 // Number of consecutive frames fitting a shorter interval required to switch to it
+#define PACING_MISSES_LIMIT 2 // Number of missed vblanks in a pacing window that forces a longer interval
+static vglFramePacingMode pacing_mode = VGL_PACING_NONE; // Current frame pacing mode
+static uint32_t pacing_max_interval = 4; // Maximum presentation interval in vblanks for frame pacing
+static volatile uint32_t pacing_interval = 1; // Current presentation interval in vblanks for frame pacing
+static uint32_t pacing_calm_frames = 0; // Number of consecutive frames fitting a shorter interval
+static uint32_t pacing_window_frames = 0; // Number of frames in current missed vblanks window
+static uint32_t pacing_window_misses = 0; // Missed vblanks counter value at current window start
+static uint64_t last_swap_time = 0; // Time last vglSwapBuffers call returned
+static uint32_t cpu_frame_time = 0; // Smoothed CPU frame time in microseconds
+static uint32_t last_cpu_frame_time = 0; // CPU frame time in microseconds of last frame
+static volatile uint32_t queued_frames = 0; // Number of frames added to the display queue
+static volatile uint32_t presented_frames = 0; // Number of frames processed by the display queue
+static volatile uint32_t last_flip_vcount = 0; // Vblank counter value at last presentation
+static volatile uint32_t last_present_vblanks = 0; // Number of vblanks between last two presentations
+static volatile uint32_t missed_vblanks = 0; // Number of presentations that missed the target interval
 
 SceGxmContext *gxm_context; // sceGxm context instance
 GLenum vgl_error = GL_NO_ERROR; // Error returned by glGetError
@@ -80,6 +167,7 @@ GLboolean is_rendering_display = GL_TRUE; // Flag for when drawing without fbo i
 
 float *legacy_pool = NULL; // Mempool for GL1 immediate draw pipeline
 float *legacy_pool_ptr = NULL; // Current address for vertices population for GL1 immediate draw pipeline
+float *legacy_pool_end = NULL; // End address of current mempool chunk for GL1 immediate draw pipeline
 
 void *frame_purge_list[FRAME_PURGE_FREQ][FRAME_PURGE_LIST_SIZE]; // Purge list for internal elements
 void *frame_rt_purge_list[FRAME_PURGE_FREQ][FRAME_PURGE_RENDERTARGETS_LIST_SIZE]; // Purge list for rendertargets
@@ -115,51 +203,129 @@ razor_results razor_metrics;
 GLboolean has_razor_live = GL_FALSE; // Flag for live metrics support with sceRazor
 #endif
 
+#define RT_CACHE_SIZE 96 // Maximum amount of render targets held by the render targets cache
+#define RT_CACHE_IDLE_BUDGET (16 * 1024 * 1024) // Maximum driver memory in bytes retained by unreferenced cached render targets
 #ifdef HAVE_SHARED_RENDERTARGETS
-#define MAX_RENDER_TARGETS_NUM 47 // Maximum amount of dedicated render targets usable for fbos
 #define MAX_SHARED_RT_SIZE 256 // Maximum  width value in pixels for shared rendertargets usage
 #define MAX_SCENES_PER_FRAME 8 // Maximum amount of scenes per frame allowed by sceGxm per render target
-render_target rt_list[MAX_RENDER_TARGETS_NUM];
+#endif
+render_target rt_list[RT_CACHE_SIZE]; // Render targets cache
+
+#define TRANSIENT_DEPTH_STENCIL_NUM 8 // Maximum amount of shared allocations backing transient depth/stencil surfaces
+typedef struct {
+	void *depth_buffer;
+	void *stencil_buffer;
+	uint32_t samples;
+	uint32_t ref_count;
+} transient_depth_stencil;
+static transient_depth_stencil transient_ds[TRANSIENT_DEPTH_STENCIL_NUM]; // Shared allocations for transient depth/stencil surfaces
+static uint32_t rt_cache_mem = 0; // Driver memory in bytes used by cached render targets
+static uint32_t rt_cache_idle_mem = 0; // Driver memory in bytes used by unreferenced cached render targets
+static uint32_t rt_cache_tick = 0; // Monotonic counter used for LRU eviction
+
+static void evictRenderTarget(render_target *rt) {
+	rt_cache_mem -= rt->mem_size;
+	rt_cache_idle_mem -= rt->mem_size;
+	_markRtAsDirty(rt->rt);
+	rt->rt = NULL;
+}
+
+static render_target *getLruRenderTarget(void) {
+	// Looking for the least recently used unreferenced render target
+	render_target *lru = NULL;
+	for (int i = 0; i < RT_CACHE_SIZE; i++) {
+		if (rt_list[i].rt && !rt_list[i].ref_count && (!lru || rt_list[i].last_used < lru->last_used))
+			lru = &rt_list[i];
+	}
+	return lru;
+}
 
 render_target *getFreeRenderTarget(int w, int h) {
 	int i;
-	for (i = 0; i < MAX_RENDER_TARGETS_NUM; i++) {
+	render_target *free_rt = NULL;
+#ifdef HAVE_SHARED_RENDERTARGETS
+	int scenes = w > MAX_SHARED_RT_SIZE ? 1 : MAX_SCENES_PER_FRAME;
+#else
+	int scenes = 1;
+#endif
+
+	// Reusing a cached render target with the same configuration if available
+	for (i = 0; i < RT_CACHE_SIZE; i++) {
 		if (rt_list[i].rt != NULL) {
-			if (w == rt_list[i].w && h == rt_list[i].h && rt_list[i].ref_count < rt_list[i].max_refs) {
+			if (w == rt_list[i].w && h == rt_list[i].h && msaa_mode == rt_list[i].msaa && scenes == rt_list[i].max_refs && rt_list[i].ref_count < rt_list[i].max_refs) {
+				if (!rt_list[i].ref_count)
+					rt_cache_idle_mem -= rt_list[i].mem_size;
 				rt_list[i].ref_count++;
+				rt_list[i].last_used = ++rt_cache_tick;
 				return &rt_list[i];
 			}
-		} else {
-			rt_list[i].max_refs = w > MAX_SHARED_RT_SIZE ? 1 : MAX_SCENES_PER_FRAME;
-			SceGxmRenderTargetParams renderTargetParams;
-			sceClibMemset(&renderTargetParams, 0, sizeof(SceGxmRenderTargetParams));
-			renderTargetParams.width = w;
-			renderTargetParams.height = h;
-			renderTargetParams.scenesPerFrame = rt_list[i].max_refs;
-			renderTargetParams.multisampleMode = msaa_mode;
-			renderTargetParams.driverMemBlock = -1;
-			sceGxmCreateRenderTarget(&renderTargetParams, &rt_list[i].rt);
-			rt_list[i].w = w;
-			rt_list[i].h = h;
-			rt_list[i].ref_count = 1;
-			return &rt_list[i];
+		} else if (!free_rt)
+			free_rt = &rt_list[i];
+	}
+
+	// Evicting least recently used unreferenced render target if the cache is full
+	GLboolean is_uncached = GL_FALSE;
+	if (!free_rt) {
+		free_rt = getLruRenderTarget();
+		if (free_rt)
+			evictRenderTarget(free_rt);
+		else {
+			// Every cached render target is referenced, so we create one owned by the caller
+			free_rt = (render_target *)vgl_malloc(sizeof(render_target), VGL_MEM_EXTERNAL);
+			if (!free_rt)
+				return NULL;
+			is_uncached = GL_TRUE;
 		}
 	}
-	return NULL;
+
+	// Creating a new render target
+	SceGxmRenderTargetParams renderTargetParams;
+	sceClibMemset(&renderTargetParams, 0, sizeof(SceGxmRenderTargetParams));
+	renderTargetParams.flags = 0;
+	renderTargetParams.width = w;
+	renderTargetParams.height = h;
+	renderTargetParams.scenesPerFrame = scenes;
+	renderTargetParams.multisampleMode = msaa_mode;
+	renderTargetParams.multisampleLocations = 0;
+	renderTargetParams.driverMemBlock = -1;
+	sceGxmGetRenderTargetMemSize(&renderTargetParams, &free_rt->mem_size);
+	sceGxmCreateRenderTarget(&renderTargetParams, &free_rt->rt);
+	free_rt->w = w;
+	free_rt->h = h;
+	free_rt->msaa = msaa_mode;
+	free_rt->max_refs = scenes;
+	free_rt->ref_count = 1;
+	free_rt->last_used = ++rt_cache_tick;
+	free_rt->is_uncached = is_uncached;
+	if (!is_uncached)
+		rt_cache_mem += free_rt->mem_size;
+	return free_rt;
 }
 
 void __markRtAsDirty(render_target *rt) {
+	// Destroying render targets created outside of the cache straight away
+	if (rt->is_uncached) {
+		_markRtAsDirty(rt->rt);
+		vgl_free(rt);
+		return;
+	}
+
+	// Keeping unreferenced render targets cached for later reuse
 	rt->ref_count--;
 	if (!rt->ref_count) {
-		_markRtAsDirty(rt->rt);
-		rt->rt = NULL;
+		rt_cache_idle_mem += rt->mem_size;
+
+		// Evicting least recently used unreferenced render targets when exceeding memory budget
+		while (rt_cache_idle_mem > RT_CACHE_IDLE_BUDGET) {
+			evictRenderTarget(getLruRenderTarget());
+		}
 	}
 }
-#endif
 
 // sceDisplay callback data
 struct display_queue_callback_data {
 	void *addr;
+	uint32_t old_buffer_idx;
 };
 
 // sceGxmShaderPatcher custom allocator
@@ -190,12 +356,36 @@ static void display_queue_callback(const void *callbackData) {
 	vgl_debugger_light_draw(cb_data->addr);
 #endif
 
-	// Setting sceDisplay framebuffer
-	sceDisplaySetFrameBuf(&display_fb, SCE_DISPLAY_SETBUF_NEXTFRAME);
+	if (pacing_mode != VGL_PACING_NONE) {
+		// Holding presentation until target interval elapsed since last flip, unless in mailbox mode with newer frames already queued
+		if (pacing_mode != VGL_PACING_MAILBOX || queued_frames - presented_frames <= 1) {
+			while ((int32_t)(sceDisplayGetVcount() + 1 - (last_flip_vcount + pacing_interval)) < 0)
+				sceDisplayWaitVblankStart();
+		}
 
-	// Performing VSync if enabled
-	if (vsync_interval)
-		sceDisplayWaitVblankStartMulti(vsync_interval);
+		// Setting sceDisplay framebuffer and waiting for it to be flipped
+		sceDisplaySetFrameBuf(&display_fb, SCE_DISPLAY_SETBUF_NEXTFRAME);
+		sceDisplayWaitVblankStart();
+
+		// Collecting presentation telemetry
+		uint32_t vcount = sceDisplayGetVcount();
+		last_present_vblanks = vcount - last_flip_vcount;
+		if (last_present_vblanks > pacing_interval)
+			missed_vblanks++;
+		last_flip_vcount = vcount;
+	} else {
+		// Setting sceDisplay framebuffer
+		sceDisplaySetFrameBuf(&display_fb, SCE_DISPLAY_SETBUF_NEXTFRAME);
+
+		// Performing VSync if enabled
+		if (vsync_interval)
+			sceDisplayWaitVblankStartMulti(vsync_interval);
+		last_flip_vcount = sceDisplayGetVcount();
+	}
+
+	// Old color surface gets released as soon as the callback returns
+	display_release_time[cb_data->old_buffer_idx] = sceKernelGetProcessTimeWide();
+	presented_frames++;
 }
 
 // Garbage collector
@@ -228,6 +418,195 @@ static int garbage_collector(unsigned int args, void *arg) {
 	return sceKernelExitDeleteThread(0);
 }
 
+// GPU timings
+static int frame_timer(unsigned int args, void *arg) {
+	volatile uint32_t *notification_region = sceGxmGetNotificationRegion();
+	uint32_t processed_frames = 0;
+	uint64_t gpu_free_time = 0;
+	for (;;) {
+		// Waiting for submitted frames
+		sceKernelWaitSema(timings_sema, 1, NULL);
+		if (stop_gpu_timers)
+			break;
+
+		while (processed_frames != timed_frames) {
+			// Skipping frames whose timings data got already overwritten
+			if (timed_frames - processed_frames > TIMINGS_FRAMES_NUM)
+				processed_frames = timed_frames - TIMINGS_FRAMES_NUM;
+			frame_timings f = timings_list[processed_frames % TIMINGS_FRAMES_NUM];
+			processed_frames++;
+
+			// Measuring GPU time from the moment the GPU got free or the frame got submitted, whatever happened last
+			if (f.has_render_notification) {
+				uint32_t slot = f.query_marker ? QUERY_NOTIFICATION : RENDER_NOTIFICATION;
+				uint32_t id = f.query_marker ? f.query_marker : f.id;
+				while ((int32_t)(notification_region[slot] - id) < 0)
+					sceKernelDelayThread(TIMINGS_POLL_DELAY);
+				uint64_t render_time = sceKernelGetProcessTimeWide();
+				uint64_t start_time = f.submit_time > gpu_free_time ? f.submit_time : gpu_free_time;
+
+				// Frames rendered straight on the display wait for their color surface to be released by the display queue
+				if (!f.has_present_notification && display_release_time[f.buffer_idx] > start_time)
+					start_time = display_release_time[f.buffer_idx];
+				uint32_t t = render_time > start_time ? render_time - start_time : 0;
+				last_gpu_frame_time = t;
+				gpu_frame_time = gpu_frame_time ? (gpu_frame_time * 3 + t) / 4 : t;
+				gpu_free_time = render_time;
+			}
+
+			// Waiting for the upscale pass so that display waits are excluded from next frame timings
+			if (f.has_present_notification) {
+				while ((int32_t)(notification_region[PRESENT_NOTIFICATION] - f.id) < 0)
+					sceKernelDelayThread(TIMINGS_POLL_DELAY);
+				gpu_free_time = sceKernelGetProcessTimeWide();
+			}
+		}
+	}
+	return sceKernelExitDeleteThread(0);
+}
+
+static void startFrameTimings(void) {
+	if (timings_thread)
+		return;
+
+	// Starting GPU timings thread
+	volatile uint32_t *notification_region = sceGxmGetNotificationRegion();
+	notification_region[RENDER_NOTIFICATION] = 0;
+	notification_region[PRESENT_NOTIFICATION] = 0;
+	timings_sema = sceKernelCreateSema("Frame Timings Sema", 0, 0, TIMINGS_FRAMES_NUM, NULL);
+	timings_thread = sceKernelCreateThread("Frame Timings", &frame_timer, gc_thread_priority, 0x4000, 0, gc_thread_affinity, NULL);
+	sceKernelStartThread(timings_thread, 0, NULL);
+}
+
+static void trackSceneSubmission(void) {
+	// Recording the time the first scene of current frame and of running timer query got submitted to the GPU
+	uint64_t submit_time = 0;
+	if (frame_timings_enabled && !frame_submit_time)
+		frame_submit_time = submit_time = sceKernelGetProcessTimeWide();
+	if (active_time_query && !active_time_query->submit_time)
+		active_time_query->submit_time = submit_time ? submit_time : sceKernelGetProcessTimeWide();
+}
+
+static void markSceneEnd(void);
+static void notifySceneEnd(uint32_t slot) {
+	// A scene can signal a single notification, so frames ending with a timer queries marker get timed through it
+	if (slot == RENDER_NOTIFICATION && active_time_query) {
+		markSceneEnd();
+		frame_query_marker = query_markers;
+		trackSceneSubmission();
+		return;
+	}
+
+	// Ending current gxm scene signaling its completion to the GPU timings thread
+	volatile uint32_t *notification_region = sceGxmGetNotificationRegion();
+	SceGxmNotification notification;
+	notification.address = &notification_region[slot];
+	notification.value = timed_frames + 1;
+	sceGxmEndScene(gxm_context, NULL, &notification);
+	trackSceneSubmission();
+}
+
+static void submitFrameTimings(GLboolean has_render_notification) {
+	// Handing current frame over to the GPU timings thread
+	frame_timings *f = &timings_list[timed_frames % TIMINGS_FRAMES_NUM];
+	f->submit_time = frame_submit_time;
+	f->id = timed_frames + 1;
+	f->query_marker = frame_query_marker;
+	f->buffer_idx = gxm_back_buffer_index;
+	f->has_render_notification = has_render_notification;
+	f->has_present_notification = dynres_enabled;
+	frame_submit_time = 0;
+	frame_query_marker = 0;
+	timed_frames++;
+	sceKernelSignalSema(timings_sema, 1);
+}
+
+// GPU timer queries
+static int query_timer(unsigned int args, void *arg) {
+	volatile uint32_t *notification_region = sceGxmGetNotificationRegion();
+	for (;;) {
+		// Waiting for submitted markers
+		sceKernelWaitSema(queries_sema, 1, NULL);
+		if (stop_gpu_timers)
+			break;
+
+		while (reached_markers != query_markers) {
+			while ((int32_t)(notification_region[QUERY_NOTIFICATION] - (reached_markers + 1)) < 0)
+				sceKernelDelayThread(TIMINGS_POLL_DELAY);
+			uint64_t reach_time = sceKernelGetProcessTimeWide();
+
+			// Markers reached between two polls share the same timing
+			uint32_t reached = notification_region[QUERY_NOTIFICATION];
+			while ((int32_t)(reached - reached_markers) > 0) {
+				marker_times[(reached_markers + 1) % QUERY_MARKERS_NUM] = reach_time;
+				reached_markers++;
+			}
+		}
+	}
+	return sceKernelExitDeleteThread(0);
+}
+
+static void startQueryTimings(void) {
+	if (queries_thread)
+		return;
+
+	// Starting GPU timer queries thread
+	volatile uint32_t *notification_region = sceGxmGetNotificationRegion();
+	notification_region[QUERY_NOTIFICATION] = 0;
+	queries_sema = sceKernelCreateSema("Timer Queries Sema", 0, 0, QUERY_MARKERS_NUM, NULL);
+	queries_thread = sceKernelCreateThread("Timer Queries", &query_timer, gc_thread_priority, 0x4000, 0, gc_thread_affinity, NULL);
+	sceKernelStartThread(queries_thread, 0, NULL);
+}
+
+void termGpuTimers(void) {
+	// Stopping GPU timings and timer queries threads (GPU is expected to be idle at this point)
+	stop_gpu_timers = GL_TRUE;
+	if (timings_thread) {
+		sceKernelSignalSema(timings_sema, 1);
+		sceKernelWaitThreadEnd(timings_thread, NULL, NULL);
+		sceKernelDeleteSema(timings_sema);
+		timings_thread = 0;
+		timed_frames = 0;
+	}
+	if (queries_thread) {
+		sceKernelSignalSema(queries_sema, 1);
+		sceKernelWaitThreadEnd(queries_thread, NULL, NULL);
+		sceKernelDeleteSema(queries_sema);
+		queries_thread = 0;
+		query_markers = reached_markers = 0;
+	}
+	stop_gpu_timers = GL_FALSE;
+}
+
+static void markSceneEnd(void) {
+	// Ending current gxm scene signaling its completion to the GPU timer queries thread
+	volatile uint32_t *notification_region = sceGxmGetNotificationRegion();
+	SceGxmNotification notification;
+	notification.address = &notification_region[QUERY_NOTIFICATION];
+	notification.value = query_markers + 1;
+	sceGxmEndScene(gxm_context, NULL, &notification);
+	query_markers++;
+	sceKernelSignalSema(queries_sema, 1);
+}
+
+static GLboolean getMarkerTime(uint32_t marker, uint64_t *time) {
+	// Markers placed before any scene got submitted have no timing
+	if (!marker) {
+		*time = 0;
+		return GL_TRUE;
+	}
+
+	// Checking if the GPU reached the marker yet
+	if ((int32_t)(reached_markers - marker) < 0)
+		return GL_FALSE;
+
+	// Timings of markers older than the retained ones are lost
+	*time = marker_times[marker % QUERY_MARKERS_NUM];
+	if (reached_markers - marker >= QUERY_MARKERS_NUM)
+		*time = 0;
+	return GL_TRUE;
+}
+
 GLboolean startShaderCompiler(void) {
 	is_shark_online = shark_init(NULL) >= 0;
 
@@ -434,7 +813,7 @@ void termDisplayColorSurfaces(void) {
 	}
 }
 
-void initDepthStencilBuffer(uint32_t w, uint32_t h, SceGxmDepthStencilSurface *surface, void **depth_buffer, void **stencil_buffer) {
+static uint32_t get_depth_stencil_samples(uint32_t w, uint32_t h, uint32_t *stride) {
 	// Calculating sizes for depth and stencil surfaces
 	unsigned int depth_stencil_width = ALIGN(w, SCE_GXM_TILE_SIZEX);
 	unsigned int depth_stencil_height = ALIGN(h, SCE_GXM_TILE_SIZEY);
@@ -443,6 +822,13 @@ void initDepthStencilBuffer(uint32_t w, uint32_t h, SceGxmDepthStencilSurface *s
 		depth_stencil_samples *= 2;
 	else if (msaa_mode == SCE_GXM_MULTISAMPLE_4X)
 		depth_stencil_samples *= 4;
+	*stride = msaa_mode == SCE_GXM_MULTISAMPLE_4X ? depth_stencil_width * 2 : depth_stencil_width;
+	return depth_stencil_samples;
+}
+
+void initDepthStencilBuffer(uint32_t w, uint32_t h, SceGxmDepthStencilSurface *surface, void **depth_buffer, void **stencil_buffer) {
+	uint32_t depth_stencil_stride;
+	uint32_t depth_stencil_samples = get_depth_stencil_samples(w, h, &depth_stencil_stride);
 	
 	// Allocating depth surface
 	*depth_buffer = gpu_alloc_mapped(4 * depth_stencil_samples, VGL_MEM_VRAM);
@@ -455,9 +841,69 @@ void initDepthStencilBuffer(uint32_t w, uint32_t h, SceGxmDepthStencilSurface *s
 	sceGxmDepthStencilSurfaceInit(surface,
 		stencil_buffer ? SCE_GXM_DEPTH_STENCIL_FORMAT_DF32M_S8 : SCE_GXM_DEPTH_STENCIL_FORMAT_DF32M,
 		SCE_GXM_DEPTH_STENCIL_SURFACE_LINEAR,
-		msaa_mode == SCE_GXM_MULTISAMPLE_4X ? depth_stencil_width * 2 : depth_stencil_width,
+		depth_stencil_stride,
 		*depth_buffer,
-		*stencil_buffer);
+		stencil_buffer ? *stencil_buffer : NULL);
+}
+
+void initTransientDepthStencilBuffer(uint32_t w, uint32_t h, SceGxmDepthStencilSurface *surface, void **depth_buffer, void **stencil_buffer) {
+	uint32_t depth_stencil_stride;
+	uint32_t depth_stencil_samples = get_depth_stencil_samples(w, h, &depth_stencil_stride);
+
+	// Looking for the smallest shared allocation big enough for the requested surface
+	transient_depth_stencil *ds = NULL, *free_ds = NULL;
+	for (int i = 0; i < TRANSIENT_DEPTH_STENCIL_NUM; i++) {
+		if (transient_ds[i].depth_buffer) {
+			if (transient_ds[i].samples >= depth_stencil_samples && (!ds || transient_ds[i].samples < ds->samples))
+				ds = &transient_ds[i];
+		} else if (!free_ds)
+			free_ds = &transient_ds[i];
+	}
+
+	// Allocating a new shared allocation if none is compatible
+	if (!ds) {
+		if (!free_ds) {
+			initDepthStencilBuffer(w, h, surface, depth_buffer, stencil_buffer);
+			return;
+		}
+		ds = free_ds;
+		ds->depth_buffer = gpu_alloc_mapped(4 * depth_stencil_samples, VGL_MEM_VRAM);
+		ds->stencil_buffer = gpu_alloc_mapped(1 * depth_stencil_samples, VGL_MEM_VRAM);
+		ds->samples = depth_stencil_samples;
+		ds->ref_count = 0;
+	}
+	ds->ref_count++;
+	*depth_buffer = ds->depth_buffer;
+	if (stencil_buffer)
+		*stencil_buffer = ds->stencil_buffer;
+
+	// Initializing depth and stencil surfaces (content is neither loaded nor stored, so it's discarded at scene end)
+	sceGxmDepthStencilSurfaceInit(surface,
+		stencil_buffer ? SCE_GXM_DEPTH_STENCIL_FORMAT_DF32M_S8 : SCE_GXM_DEPTH_STENCIL_FORMAT_DF32M,
+		SCE_GXM_DEPTH_STENCIL_SURFACE_LINEAR,
+		depth_stencil_stride,
+		ds->depth_buffer,
+		stencil_buffer ? ds->stencil_buffer : NULL);
+}
+
+void freeDepthStencilBuffer(void *depth_buffer, void *stencil_buffer) {
+	// Releasing a reference to a shared allocation
+	for (int i = 0; i < TRANSIENT_DEPTH_STENCIL_NUM; i++) {
+		if (transient_ds[i].depth_buffer == depth_buffer) {
+			transient_ds[i].ref_count--;
+			if (!transient_ds[i].ref_count) {
+				markAsDirty(transient_ds[i].depth_buffer);
+				markAsDirty(transient_ds[i].stencil_buffer);
+				transient_ds[i].depth_buffer = NULL;
+			}
+			return;
+		}
+	}
+
+	// Dedicated allocation
+	markAsDirty(depth_buffer);
+	if (stencil_buffer)
+		markAsDirty(stencil_buffer);
 }
 
 void initDepthStencilSurfaces(void) {
@@ -529,29 +975,319 @@ void waitRenderingDone(void) {
 }
 
 void sceneEnd(void) {
-	// Ends current gxm scene
-	sceGxmEndScene(gxm_context, NULL, NULL);
+	// Ends current gxm scene, placing a timer queries marker if required
+	if (active_time_query || needs_query_marker)
+		markSceneEnd();
+	else
+		sceGxmEndScene(gxm_context, NULL, NULL);
+	trackSceneSubmission();
 	if (system_app_mode && vsync_interval)
 		sceDisplayWaitVblankStartMulti(vsync_interval);
 }
 
+void sceneBeginFrame(void) {
+	// Performing per frame bookkeeping without starting a gxm scene
+	if (!needs_end_scene) {
+		resetLegacyPool();
+#ifdef HAVE_STATIC_ARRAYS_CACHE
+		tickStaticArraysCache();
+#endif
+		needs_end_scene = GL_TRUE;
+		is_scene_interrupted = GL_TRUE;
+	}
+}
+
+void sceneInterrupt(void) {
+	// Ending current gxm scene (if any) so that following transfer jobs are ordered after its rendering
+	flush_pending_draws();
+	if (!needs_scene_reset) {
+		sceneEnd();
+		is_scene_interrupted = GL_TRUE;
+	}
+
+	// Forcing a new scene on next draw call
+	needs_scene_reset = GL_TRUE;
+}
+
+static GLboolean initUpscaleProgram(void) {
+	if (upscale_vertex_program_patched)
+		return GL_TRUE;
+
+	// Restarting vitaShaRK if we released it before
+	if (!is_shark_online && !startShaderCompiler())
+		return GL_FALSE;
+
+	// Compiling upscale pass shaders
+	uint32_t size = strlen(upscale_vert_src);
+	SceGxmProgram *t = shark_compile_shader_extended(upscale_vert_src, &size, SHARK_VERTEX_SHADER, compiler_opts, compiler_fastmath, compiler_fastprecision, compiler_fastint);
+	if (!t)
+		return GL_FALSE;
+	upscale_vertex_program = (SceGxmProgram *)vgl_malloc(size, VGL_MEM_EXTERNAL);
+	sceClibMemcpy((void *)upscale_vertex_program, (void *)t, size);
+	shark_clear_output();
+	size = strlen(upscale_frag_src);
+	t = shark_compile_shader_extended(upscale_frag_src, &size, SHARK_FRAGMENT_SHADER, compiler_opts, compiler_fastmath, compiler_fastprecision, compiler_fastint);
+	if (!t) {
+		vgl_free(upscale_vertex_program);
+		upscale_vertex_program = NULL;
+		return GL_FALSE;
+	}
+	upscale_fragment_program = (SceGxmProgram *)vgl_malloc(size, VGL_MEM_EXTERNAL);
+	sceClibMemcpy((void *)upscale_fragment_program, (void *)t, size);
+	shark_clear_output();
+
+	// Registering and patching upscale pass shaders
+	sceGxmShaderPatcherRegisterProgram(gxm_shader_patcher, upscale_vertex_program, &upscale_vertex_id);
+	sceGxmShaderPatcherRegisterProgram(gxm_shader_patcher, upscale_fragment_program, &upscale_fragment_id);
+	patchVertexProgram(gxm_shader_patcher,
+		upscale_vertex_id, NULL, 0, NULL, 0, &upscale_vertex_program_patched);
+	patchFragmentProgram(gxm_shader_patcher,
+		upscale_fragment_id, SCE_GXM_OUTPUT_REGISTER_FORMAT_UCHAR4,
+		msaa_mode, NULL, NULL,
+		&upscale_fragment_program_patched);
+	return GL_TRUE;
+}
+
+static void releaseDynamicResolutionTarget(void) {
+	if (dynres_rt) {
+		markRtAsDirty(dynres_rt);
+		dynres_rt = NULL;
+	}
+	if (dynres_color_addr) {
+		markAsDirty(dynres_color_addr);
+		dynres_color_addr = NULL;
+	}
+}
+
+static void updateDynamicResolutionScale(void) {
+	// Waiting for the previous scale change to show up in measured GPU timings
+	uint32_t gpu_time = gpu_frame_time;
+	uint32_t steps = dynres_steps;
+	if (dynres_frames_since_update < DYNRES_UPDATE_RATIO)
+		dynres_frames_since_update++;
+
+	// GPU time is assumed to be proportional to the amount of rendered pixels, so we aim for 90% of the target to absorb load spikes
+	if (gpu_time && dynres_frames_since_update == DYNRES_UPDATE_RATIO &&
+		(gpu_time > dynres_target_time || gpu_time < dynres_target_time * 8 / 10))
+		steps = (uint32_t)(dynres_steps * sqrtf(0.9f * dynres_target_time / gpu_time) + 0.5f);
+	if (steps < dynres_min_steps)
+		steps = dynres_min_steps;
+	else if (steps > dynres_max_steps)
+		steps = dynres_max_steps;
+	if (steps != dynres_steps) {
+		dynres_steps = steps;
+		dynres_frames_since_update = 0;
+	}
+}
+
+static void updateDynamicResolutionTarget(void) {
+	// Applying dynamic resolution mode changes at frame boundaries only
+	dynres_enabled = GL_FALSE;
+	if (!dynres_requested) {
+		releaseDynamicResolutionTarget();
+		return;
+	}
+	updateDynamicResolutionScale();
+
+	// Allocating dynamic resolution color surface with display size so that it never needs to be reallocated
+	if (!dynres_color_addr) {
+		dynres_color_addr = gpu_alloc_mapped_aligned(4096, ALIGN(4 * DISPLAY_STRIDE * DISPLAY_HEIGHT, 1 * 1024 * 1024), VGL_MEM_VRAM);
+		if (!dynres_color_addr) {
+			dynres_requested = GL_FALSE;
+			return;
+		}
+	}
+
+	// Getting a render target for current scale
+	uint32_t w = DISPLAY_WIDTH * dynres_steps / DYNRES_SCALE_STEPS;
+	uint32_t h = DISPLAY_HEIGHT * dynres_steps / DYNRES_SCALE_STEPS;
+	if (!dynres_rt || w != dynres_width || h != dynres_height) {
+		if (dynres_rt)
+			markRtAsDirty(dynres_rt);
+		dynres_rt = getFreeRenderTarget(w, h);
+		if (!dynres_rt) {
+			releaseDynamicResolutionTarget();
+			dynres_requested = GL_FALSE;
+			return;
+		}
+		dynres_width = w;
+		dynres_height = h;
+
+		// Initializing color surface and upscale pass texture on the used portion of the memblock
+		sceGxmColorSurfaceInit(&dynres_color_surface,
+			SCE_GXM_COLOR_FORMAT_A8B8G8R8,
+			SCE_GXM_COLOR_SURFACE_LINEAR,
+			msaa_mode == SCE_GXM_MULTISAMPLE_NONE ? SCE_GXM_COLOR_SURFACE_SCALE_NONE : SCE_GXM_COLOR_SURFACE_SCALE_MSAA_DOWNSCALE,
+			SCE_GXM_OUTPUT_REGISTER_SIZE_32BIT,
+			w, h, DISPLAY_STRIDE, dynres_color_addr);
+		sceGxmTextureInitLinearStrided(&dynres_tex, dynres_color_addr, SCE_GXM_TEXTURE_FORMAT_U8U8U8U8_ABGR, w, h, DISPLAY_STRIDE * 4);
+		vglSetTexUMode(&dynres_tex, SCE_GXM_TEXTURE_ADDR_CLAMP);
+		vglSetTexVMode(&dynres_tex, SCE_GXM_TEXTURE_ADDR_CLAMP);
+		vglSetTexMinFilter(&dynres_tex, SCE_GXM_TEXTURE_FILTER_LINEAR);
+		vglSetTexMagFilter(&dynres_tex, SCE_GXM_TEXTURE_FILTER_LINEAR);
+	}
+	dynres_enabled = GL_TRUE;
+}
+
+static void presentDynamicResolutionTarget(void) {
+	// Starting upscale pass scene on the display
+	sceGxmBeginScene(gxm_context, 0, gxm_render_target,
+		NULL, NULL,
+		gxm_sync_objects[gxm_back_buffer_index],
+		&gxm_color_surfaces[gxm_back_buffer_index],
+		NULL);
+	vglSetSurfaceScale(1.0f, 1.0f);
+	vglInvalidateGxmState(GXM_STATE_VIEWPORT | GXM_STATE_REGION_CLIP);
+	vglSetRegionClip(SCE_GXM_REGION_CLIP_OUTSIDE, 0, 0, DISPLAY_WIDTH - 1, DISPLAY_HEIGHT - 1);
+
+	// Invalidating viewport, culling, polygon mode and depth/stencil tests
+	invalidate_viewport();
+	vglSetCullMode(SCE_GXM_CULL_NONE);
+	invalidate_depth_test();
+	change_depth_write(SCE_GXM_DEPTH_WRITE_DISABLED);
+	vglSetFrontPolygonMode(SCE_GXM_POLYGON_MODE_TRIANGLE_FILL);
+	vglSetBackPolygonMode(SCE_GXM_POLYGON_MODE_TRIANGLE_FILL);
+	vglSetFrontStencilFunc(
+		SCE_GXM_STENCIL_FUNC_ALWAYS,
+		SCE_GXM_STENCIL_OP_KEEP,
+		SCE_GXM_STENCIL_OP_KEEP,
+		SCE_GXM_STENCIL_OP_KEEP,
+		0xFF, 0xFF);
+	vglSetBackStencilFunc(
+		SCE_GXM_STENCIL_FUNC_ALWAYS,
+		SCE_GXM_STENCIL_OP_KEEP,
+		SCE_GXM_STENCIL_OP_KEEP,
+		SCE_GXM_STENCIL_OP_KEEP,
+		0xFF, 0xFF);
+
+	// Drawing the dynamic resolution color surface stretched over the whole display
+	sceGxmSetVertexProgram(gxm_context, upscale_vertex_program_patched);
+	sceGxmSetFragmentProgram(gxm_context, upscale_fragment_program_patched);
+	sceGxmSetFragmentTexture(gxm_context, 0, &dynres_tex);
+	vglFlushGxmState();
+	sceGxmDraw(gxm_context, SCE_GXM_PRIMITIVE_TRIANGLE_FAN, SCE_GXM_INDEX_FORMAT_U16, depth_clear_indices, 4);
+
+	// Ending upscale pass scene signaling when the GPU completes it
+	notifySceneEnd(PRESENT_NOTIFICATION);
+
+	// Restoring viewport, culling, polygon mode and depth/stencil tests
+	validate_depth_test();
+	change_depth_write(depth_mask_state ? SCE_GXM_DEPTH_WRITE_ENABLED : SCE_GXM_DEPTH_WRITE_DISABLED);
+	change_stencil_settings();
+	vglSetFrontPolygonMode(polygon_mode_front);
+	vglSetBackPolygonMode(polygon_mode_back);
+	validate_viewport();
+	change_cull_mode();
+}
+
+static void updateFramePacing(void) {
+	if (last_cpu_frame_time)
+		cpu_frame_time = cpu_frame_time ? (cpu_frame_time * 3 + last_cpu_frame_time) / 4 : last_cpu_frame_time;
+
+	// Picking the shortest interval fitting the slowest between CPU and GPU with a 10% headroom
+	uint32_t frame_time = cpu_frame_time > gpu_frame_time ? cpu_frame_time : gpu_frame_time;
+	uint32_t min_interval = vsync_interval ? vsync_interval : 1;
+	uint32_t interval = (frame_time * 11 / 10 + VBLANK_TIME - 1) / VBLANK_TIME;
+
+	// Repeatedly missed vblanks mean that frame time is being underestimated
+	if (++pacing_window_frames > PACING_DECREASE_FRAMES) {
+		pacing_window_frames = 0;
+		pacing_window_misses = missed_vblanks;
+	} else if (missed_vblanks - pacing_window_misses >= PACING_MISSES_LIMIT && interval <= pacing_interval)
+		interval = pacing_interval + 1;
+	if (interval < min_interval)
+		interval = min_interval;
+	else if (interval > pacing_max_interval)
+		interval = pacing_max_interval;
+
+	// Switching to longer intervals right away and to shorter ones only once frame time got stable
+	if (interval > pacing_interval || (interval < pacing_interval && ++pacing_calm_frames >= PACING_DECREASE_FRAMES)) {
+		pacing_interval = interval < pacing_interval ? pacing_interval - 1 : interval;
+		pacing_calm_frames = 0;
+		pacing_window_frames = 0;
+		pacing_window_misses = missed_vblanks;
+	} else if (interval >= pacing_interval)
+		pacing_calm_frames = 0;
+}
+
+static inline uint32_t clear_channel(float v) {
+	return (uint32_t)(min(max(v, 0.0f), 1.0f) * 255.0f);
+}
+
+GLboolean sceneClear(GLbitfield mask) {
+	// Clears can be folded into scene start only if nothing has been drawn yet on the target
+	if (in_use_framebuffer == active_write_fb && !needs_scene_reset)
+		return GL_FALSE;
+
+	// Scissored and partially masked clears need to go through a draw call
+	if (scissor_test_state)
+		return GL_FALSE;
+	if ((mask & GL_STENCIL_BUFFER_BIT) && (stencil_mask_front_write & stencil_mask_back_write) != 0xFF)
+		return GL_FALSE;
+	if ((mask & GL_COLOR_BUFFER_BIT) && blend_color_mask != SCE_GXM_COLOR_MASK_ALL)
+		return GL_FALSE;
+
+	// sceGxmTransferFill can only be used on RGBA8888 color surfaces whose address is already known
+	if (mask & GL_COLOR_BUFFER_BIT) {
+		if (active_write_fb) {
+			if (!active_write_fb->tex || active_write_fb->data_type != GL_RGBA)
+				return GL_FALSE;
+		} else if (system_app_mode)
+			return GL_FALSE;
+	}
+
+	// Ending any running scene so that the fill is ordered after its rendering
+	sceneInterrupt();
+
+	// Marking the target as in use like a clear draw would, the scene itself will be started at next draw call
+	in_use_framebuffer = active_write_fb;
+	is_rendering_display = !active_write_fb;
+
+	// Filling color surface with the clear color
+	if (mask & GL_COLOR_BUFFER_BIT) {
+		uint32_t clr = clear_channel(clear_rgba_val.r) | (clear_channel(clear_rgba_val.g) << 8) |
+			(clear_channel(clear_rgba_val.b) << 16) | (clear_channel(clear_rgba_val.a) << 24);
+		if (active_write_fb)
+			sceGxmTransferFill(clr, SCE_GXM_TRANSFER_FORMAT_U8U8U8U8_ABGR,
+				active_write_fb->data, 0, 0, active_write_fb->width, active_write_fb->height, active_write_fb->stride,
+				NULL, SCE_GXM_TRANSFER_FRAGMENT_SYNC | SCE_GXM_TRANSFER_VERTEX_SYNC, NULL);
+		else if (dynres_enabled)
+			sceGxmTransferFill(clr, SCE_GXM_TRANSFER_FORMAT_U8U8U8U8_ABGR,
+				dynres_color_addr, 0, 0, dynres_width, dynres_height, DISPLAY_STRIDE * 4,
+				NULL, SCE_GXM_TRANSFER_FRAGMENT_SYNC | SCE_GXM_TRANSFER_VERTEX_SYNC, NULL);
+		else
+			sceGxmTransferFill(clr, SCE_GXM_TRANSFER_FORMAT_U8U8U8U8_ABGR,
+				gxm_color_surfaces_addr[gxm_back_buffer_index], 0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT, DISPLAY_STRIDE * 4,
+				gxm_sync_objects[gxm_back_buffer_index], SCE_GXM_TRANSFER_FRAGMENT_SYNC | SCE_GXM_TRANSFER_VERTEX_SYNC, NULL);
+	}
+
+	// Depth and stencil surfaces are never loaded at scene start, so their background values act as clear values
+	SceGxmDepthStencilSurface *ds = active_write_fb ? active_write_fb->depthbuffer_ptr : &gxm_depth_stencil_surface;
+	if (ds) {
+		if ((mask & GL_DEPTH_BUFFER_BIT) && depth_mask_state)
+			sceGxmDepthStencilSurfaceSetBackgroundDepth(ds, depth_value);
+		if (mask & GL_STENCIL_BUFFER_BIT)
+			sceGxmDepthStencilSurfaceSetBackgroundStencil(ds, stencil_value & 0xFF);
+	}
+
+	return GL_TRUE;
+}
+
 void sceneReset(void) {
 	if (in_use_framebuffer != active_write_fb || needs_scene_reset) {
 		needs_scene_reset = GL_FALSE;
 		in_use_framebuffer = active_write_fb;
 
 		// Ending drawing scene
-		if (needs_end_scene)
+		flush_pending_draws();
+		if (needs_end_scene && !is_scene_interrupted)
 			sceneEnd();
-		else {
-			if (legacy_pool_size) {
-				legacy_pool = (float *)gpu_alloc_mapped_temp(legacy_pool_size);
-				legacy_pool_ptr = legacy_pool;
-			}
-			needs_end_scene = GL_TRUE;
-		}
+		else
+			sceneBeginFrame();
+		is_scene_interrupted = GL_FALSE;
 
 		// Starting drawing scene
+		frame_scenes++;
 		is_rendering_display = !active_write_fb;
 		if (is_rendering_display) { // Default framebuffer is used
 			if (system_app_mode) {
@@ -559,51 +1295,53 @@ void sceneReset(void) {
 				shared_fb_info.vsync = vsync_interval;
 				gxm_back_buffer_index = (shared_fb_info.index + 1) % 2;
 			}
+			if (dynres_enabled) {
+				// Rendering on the dynamic resolution render target, display gets written by the upscale pass at swap
 #ifdef LOG_ERRORS
-			int r = sceGxmBeginScene(gxm_context, 0, gxm_render_target,
-				NULL, NULL,
-				gxm_sync_objects[gxm_back_buffer_index],
-				&gxm_color_surfaces[gxm_back_buffer_index],
-				&gxm_depth_stencil_surface);
-			if (r)
-				vgl_log("Scene reset failed due to sceGxmBeginScene erroring (%s) on display.\n", get_gxm_error_literal(r));
+				int r =
+#endif
+					sceGxmBeginScene(gxm_context, 0, dynres_rt->rt,
+						NULL, NULL, NULL,
+						&dynres_color_surface,
+						&gxm_depth_stencil_surface);
+#ifdef LOG_ERRORS
+				if (r)
+					vgl_log("Scene reset failed due to sceGxmBeginScene erroring (%s) on dynamic resolution target.\n", get_gxm_error_literal(r));
+#endif
+			} else {
+#ifdef LOG_ERRORS
+				int r = sceGxmBeginScene(gxm_context, 0, gxm_render_target,
+					NULL, NULL,
+					gxm_sync_objects[gxm_back_buffer_index],
+					&gxm_color_surfaces[gxm_back_buffer_index],
+					&gxm_depth_stencil_surface);
+				if (r)
+					vgl_log("Scene reset failed due to sceGxmBeginScene erroring (%s) on display.\n", get_gxm_error_literal(r));
 #else
-			sceGxmBeginScene(gxm_context, 0, gxm_render_target,
-				NULL, NULL,
-				gxm_sync_objects[gxm_back_buffer_index],
-				&gxm_color_surfaces[gxm_back_buffer_index],
-				&gxm_depth_stencil_surface);
+				sceGxmBeginScene(gxm_context, 0, gxm_render_target,
+					NULL, NULL,
+					gxm_sync_objects[gxm_back_buffer_index],
+					&gxm_color_surfaces[gxm_back_buffer_index],
+					&gxm_depth_stencil_surface);
 #endif
+			}
 		} else {
 			// If a rendertarget is not bound to the in use framebuffer, we get one for it
-			if (!active_write_fb->target) {
-#ifdef HAVE_SHARED_RENDERTARGETS
+			if (!active_write_fb->target)
 				active_write_fb->target = (SceGxmRenderTarget *)getFreeRenderTarget(active_write_fb->width, active_write_fb->height);
-#else
-				SceGxmRenderTargetParams renderTargetParams;
-				sceClibMemset(&renderTargetParams, 0, sizeof(SceGxmRenderTargetParams));
-				renderTargetParams.flags = 0;
-				renderTargetParams.width = active_write_fb->width;
-				renderTargetParams.height = active_write_fb->height;
-				renderTargetParams.scenesPerFrame = 1;
-				renderTargetParams.multisampleMode = msaa_mode;
-				renderTargetParams.multisampleLocations = 0;
-				renderTargetParams.driverMemBlock = -1;
-				sceGxmCreateRenderTarget(&renderTargetParams, &active_write_fb->target);
-#endif
-			}
-#ifdef HAVE_SHARED_RENDERTARGETS
 			render_target *fbo_rt = (render_target *)active_write_fb->target;
+			if (!fbo_rt) {
 #ifdef LOG_ERRORS
-			int r =
+				vgl_log("Scene reset failed due to render target allocation failure on framebuffer 0x%08X.\n", active_write_fb);
 #endif
-				sceGxmBeginScene(gxm_context, 0, fbo_rt->rt,
-#else
+				is_scene_interrupted = GL_TRUE;
+				needs_scene_reset = GL_TRUE;
+				return;
+			}
 #ifdef LOG_ERRORS
 			int r =
 #endif
-				sceGxmBeginScene(gxm_context, 0, active_write_fb->target,
-#endif
+				sceGxmBeginScene(gxm_context, 0, fbo_rt->rt,
 					NULL, NULL, NULL,
 					&active_write_fb->colorbuffer,
 					active_write_fb->depthbuffer_ptr);
@@ -613,28 +1351,32 @@ void sceneReset(void) {
 #endif
 		}
 
+		// Scaling display space viewport and region clip to the dynamic resolution render target
+		if (is_rendering_display && dynres_enabled)
+			vglSetSurfaceScale((float)dynres_width / DISPLAY_WIDTH_FLOAT, (float)dynres_height / DISPLAY_HEIGHT_FLOAT);
+		else
+			vglSetSurfaceScale(1.0f, 1.0f);
+
+		// sceGxm resets viewport and region clip at scene start, so their shadow values are no longer reliable
+		vglInvalidateGxmState(GXM_STATE_VIEWPORT | GXM_STATE_REGION_CLIP);
+
 		// Setting back current viewport if enabled cause sceGxm will reset it at sceGxmEndScene call
 		if (old_framebuffer != in_use_framebuffer) {
 			old_framebuffer = in_use_framebuffer;
 			glViewport(gl_viewport.x, gl_viewport.y, gl_viewport.w, gl_viewport.h);
-			skip_scene_reset = GL_TRUE;
 			glScissor(region.x, region.gl_y, region.w, region.h);
-			skip_scene_reset = GL_FALSE;
 #ifndef HAVE_UNFLIPPED_FBOS
 			change_cull_mode();
 #endif
 		} else
-			setViewport(gxm_context, x_port, x_scale, y_port, y_scale, z_port, z_scale);
+			vglSetViewport(x_port, x_scale, y_port, y_scale, z_port, z_scale);
 
-		if (scissor_test_state)
-			sceGxmSetRegionClip(gxm_context, SCE_GXM_REGION_CLIP_OUTSIDE, region.x, region.y, region.x + region.w - 1, region.y + region.h - 1);
-		else {
-			if (is_rendering_display)
-				sceGxmSetRegionClip(gxm_context, SCE_GXM_REGION_CLIP_OUTSIDE, 0, 0, DISPLAY_WIDTH - 1, DISPLAY_HEIGHT - 1);
-			else
-				sceGxmSetRegionClip(gxm_context, SCE_GXM_REGION_CLIP_OUTSIDE, 0, 0, in_use_framebuffer->width - 1, in_use_framebuffer->height - 1);
-		}
+		// Setting back scissor test since stencil mask and region clip got reset
+		reset_scissor_test();
 	}
+
+	// Applying deferred scissor test changes before the draw call
+	flush_scissor_test();
 }
 
 /*
@@ -672,11 +1414,142 @@ void vglSetUSSEBufferSize(uint32_t size) {
 	gxm_usse_buf_size = size;
 }
 
+void vglGetSceneStats(uint32_t *last_frame, uint32_t *peak) {
+	if (last_frame)
+		*last_frame = last_frame_scenes;
+	if (peak)
+		*peak = peak_frame_scenes;
+}
+
+void vglResetSceneStats(void) {
+	last_frame_scenes = 0;
+	peak_frame_scenes = 0;
+}
+
+void vglSetDynamicResolution(GLboolean enable, float min_scale, float max_scale, uint32_t target_frame_time) {
+#ifndef SKIP_ERROR_HANDLING
+	if (min_scale <= 0.0f || min_scale > max_scale || max_scale > 1.0f || !target_frame_time) {
+		SET_GL_ERROR(GL_INVALID_VALUE)
+	}
+#endif
+
+	// Dynamic resolution requires display color surfaces owned by vitaGL and a shader compiler for the upscale pass
+	if (enable && (system_app_mode || !initUpscaleProgram())) {
+		SET_GL_ERROR(GL_INVALID_OPERATION)
+	}
+
+	// Quantizing scale bounds to the available steps
+	dynres_min_steps = (uint32_t)ceilf(min_scale * DYNRES_SCALE_STEPS);
+	dynres_max_steps = (uint32_t)(max_scale * DYNRES_SCALE_STEPS);
+	if (!dynres_min_steps)
+		dynres_min_steps = 1;
+	if (dynres_max_steps < dynres_min_steps)
+		dynres_max_steps = dynres_min_steps;
+	dynres_target_time = target_frame_time;
+	dynres_frames_since_update = DYNRES_UPDATE_RATIO;
+	dynres_requested = enable;
+	if (enable)
+		startFrameTimings();
+}
+
+float vglGetDynamicResolutionScale(void) {
+	return dynres_enabled ? (float)dynres_steps / DYNRES_SCALE_STEPS : 1.0f;
+}
+
+void getDefaultColorSurface(void **addr, int *width, int *height, SceGxmSyncObject **sync) {
+	// Default framebuffer is backed by the dynamic resolution render target while the mode is active
+	if (dynres_enabled) {
+		*addr = dynres_color_addr;
+		*width = dynres_width;
+		*height = dynres_height;
+		if (sync)
+			*sync = NULL;
+	} else {
+		*addr = gxm_color_surfaces_addr[gxm_back_buffer_index];
+		*width = DISPLAY_WIDTH;
+		*height = DISPLAY_HEIGHT;
+		if (sync)
+			*sync = gxm_sync_objects[gxm_back_buffer_index];
+	}
+}
+
+void termDynamicResolution(void) {
+	// Deallocating dynamic resolution render target and color surface
+	if (dynres_rt)
+		markRtAsDirty(dynres_rt);
+	if (dynres_color_addr)
+		vgl_free(dynres_color_addr);
+	dynres_rt = NULL;
+	dynres_color_addr = NULL;
+	dynres_width = dynres_height = 0;
+	dynres_requested = dynres_enabled = GL_FALSE;
+
+	// Releasing upscale pass shaders
+	if (upscale_vertex_program_patched) {
+		sceGxmShaderPatcherReleaseVertexProgram(gxm_shader_patcher, upscale_vertex_program_patched);
+		sceGxmShaderPatcherReleaseFragmentProgram(gxm_shader_patcher, upscale_fragment_program_patched);
+		sceGxmShaderPatcherUnregisterProgram(gxm_shader_patcher, upscale_vertex_id);
+		sceGxmShaderPatcherUnregisterProgram(gxm_shader_patcher, upscale_fragment_id);
+		vgl_free(upscale_vertex_program);
+		vgl_free(upscale_fragment_program);
+		upscale_vertex_program = NULL;
+		upscale_fragment_program = NULL;
+		upscale_vertex_program_patched = NULL;
+		upscale_fragment_program_patched = NULL;
+	}
+}
+
+void vglSetFramePacing(vglFramePacingMode mode, uint32_t max_interval) {
+#ifndef SKIP_ERROR_HANDLING
+	if (mode > VGL_PACING_MAILBOX || !max_interval) {
+		SET_GL_ERROR(GL_INVALID_VALUE)
+	}
+#endif
+
+	// Frame pacing is performed in the display queue callback which is not used in system app mode
+	if (mode != VGL_PACING_NONE && system_app_mode) {
+		SET_GL_ERROR(GL_INVALID_OPERATION)
+	}
+
+	pacing_mode = mode;
+	pacing_max_interval = max_interval;
+	pacing_interval = vsync_interval ? vsync_interval : 1;
+	pacing_calm_frames = 0;
+	last_swap_time = 0;
+	if (mode != VGL_PACING_NONE)
+		startFrameTimings();
+}
+
+void vglGetFramePacingStats(uint32_t *cpu_time, uint32_t *gpu_time, uint32_t *present_vblanks, uint32_t *target_vblanks, uint32_t *missed) {
+	if (cpu_time)
+		*cpu_time = last_cpu_frame_time;
+	if (gpu_time)
+		*gpu_time = last_gpu_frame_time;
+	if (present_vblanks)
+		*present_vblanks = last_present_vblanks;
+	if (target_vblanks)
+		*target_vblanks = pacing_mode != VGL_PACING_NONE ? pacing_interval : vsync_interval;
+	if (missed)
+		*missed = missed_vblanks;
+}
+
+void vglResetFramePacingStats(void) {
+	missed_vblanks = 0;
+	pacing_window_misses = 0;
+}
+
 void vglUseTripleBuffering(GLboolean usage) {
 	gxm_display_buffer_count = usage ? 3 : 2;
 }
 
 void vglSwapBuffers(GLboolean has_commondialog) {
+	// Measuring CPU time spent on the frame since last swap
+	if (pacing_mode != VGL_PACING_NONE) {
+		uint64_t swap_time = sceKernelGetProcessTimeWide();
+		last_cpu_frame_time = last_swap_time ? swap_time - last_swap_time : 0;
+	}
+
+	flush_pending_draws();
 #ifdef HAVE_RAZOR_INTERFACE
 	if (!in_use_framebuffer) {
 		vgl_debugger_draw();
@@ -685,8 +1558,26 @@ void vglSwapBuffers(GLboolean has_commondialog) {
 
 	needs_end_scene = GL_FALSE;
 
-	if (!needs_scene_reset)
-		sceneEnd();
+	// Ending last scene of the frame, signaling its completion to the GPU timings thread if required
+	GLboolean is_frame_timed = frame_timings_enabled && !in_use_framebuffer;
+	if (!needs_scene_reset) {
+		if (is_frame_timed)
+			notifySceneEnd(RENDER_NOTIFICATION);
+		else
+			sceneEnd();
+	}
+
+	// Upscaling dynamic resolution render target to the display
+	if (dynres_enabled && !in_use_framebuffer)
+		presentDynamicResolutionTarget();
+	if (is_frame_timed)
+		submitFrameTimings(!needs_scene_reset);
+
+	// Updating scenes count stats
+	last_frame_scenes = frame_scenes;
+	if (frame_scenes > peak_frame_scenes)
+		peak_frame_scenes = frame_scenes;
+	frame_scenes = 0;
 
 	if (has_commondialog) {
 		// Populating SceCommonDialog parameters
@@ -810,19 +1701,34 @@ void vglSwapBuffers(GLboolean has_commondialog) {
 #endif
 			struct display_queue_callback_data queue_cb_data;
 			queue_cb_data.addr = gxm_color_surfaces_addr[gxm_back_buffer_index];
+			queue_cb_data.old_buffer_idx = gxm_front_buffer_index;
 			sceGxmDisplayQueueAddEntry(gxm_sync_objects[gxm_front_buffer_index],
 				gxm_sync_objects[gxm_back_buffer_index], &queue_cb_data);
+			queued_frames++;
 			gxm_front_buffer_index = gxm_back_buffer_index;
 			gxm_back_buffer_index = (gxm_back_buffer_index + 1) % gxm_display_buffer_count;
 		}
 	}
 	needs_scene_reset = GL_TRUE;
 
+	// Applying dynamic resolution changes for next frame
+	if (dynres_enabled || dynres_requested)
+		updateDynamicResolutionTarget();
+
+	// Updating presentation interval for next frame
+	if (pacing_mode != VGL_PACING_NONE) {
+		updateFramePacing();
+		last_swap_time = sceKernelGetProcessTimeWide();
+	}
+	frame_timings_enabled = dynres_enabled || pacing_mode != VGL_PACING_NONE;
+
 	// Starting garbage collector job
 	sceKernelSignalSema(gc_mutex, 1);
 }
 
 void glFinish(void) {
+	flush_pending_draws();
+
 	// Waiting for GPU to finish drawing jobs
 	sceGxmFinish(gxm_context);
 }
@@ -835,9 +1741,211 @@ void glReleaseShaderCompiler(void) {
 }
 
 void glFlush(void) {
+	flush_pending_draws();
 	needs_end_scene = GL_FALSE;
 	if (!needs_scene_reset)
 		sceneEnd();
 
 	needs_scene_reset = GL_TRUE;
 }
+
+static void placeQueryMarker(void) {
+	// Ending current gxm scene (if any) so that the GPU signals when all previously submitted rendering is done
+	needs_query_marker = GL_TRUE;
+	sceneInterrupt();
+	needs_query_marker = GL_FALSE;
+}
+
+static GLboolean resolveQuery(query_object *q) {
+	if (q->has_result)
+		return GL_TRUE;
+
+	// Checking if the GPU reached query markers yet
+	uint64_t start_time, end_time;
+	if (!getMarkerTime(q->start_marker, &start_time) || !getMarkerTime(q->end_marker, &end_time))
+		return GL_FALSE;
+
+	if (q->target == GL_TIMESTAMP) {
+		// Timestamps are taken when previous rendering got completed or at query time if the GPU was already idle
+		q->result = end_time > q->submit_time ? end_time : q->submit_time;
+	} else {
+		// Measuring GPU time from the moment the GPU got free or the first query scene got submitted, whatever happened last
+		if (start_time < q->submit_time)
+			start_time = q->submit_time;
+		if (q->submit_time && q->end_marker != q->start_marker && end_time > start_time)
+			q->result = end_time - start_time;
+		else
+			q->result = 0;
+	}
+
+	// Query results are expressed in nanoseconds
+	q->result *= 1000;
+	q->has_result = GL_TRUE;
+	return GL_TRUE;
+}
+
+static GLboolean getQueryObject(GLuint id, GLenum pname, uint64_t *value) {
+	query_object *q = (query_object *)id;
+#ifndef SKIP_ERROR_HANDLING
+	if (!q || !q->active || !q->target || q == active_time_query) {
+		SET_GL_ERROR_WITH_RET(GL_INVALID_OPERATION, GL_FALSE)
+	}
+#endif
+
+	switch (pname) {
+	case GL_QUERY_RESULT_AVAILABLE:
+		*value = resolveQuery(q);
+		break;
+	case GL_QUERY_RESULT:
+		// Waiting for the GPU timer queries thread to time query markers
+		while (!resolveQuery(q)) {
+			sceKernelDelayThread(TIMINGS_POLL_DELAY);
+		}
+		*value = q->result;
+		break;
+	default:
+		SET_GL_ERROR_WITH_RET(GL_INVALID_ENUM, GL_FALSE)
+	}
+	return GL_TRUE;
+}
+
+void glGenQueries(GLsizei n, GLuint *ids) {
+	int i = 0, j = 0;
+#ifndef SKIP_ERROR_HANDLING
+	if (n < 0) {
+		SET_GL_ERROR(GL_INVALID_VALUE)
+	}
+#endif
+	for (i = 0; i < QUERIES_NUM; i++) {
+		if (j >= n)
+			break;
+		if (!queries[i].active) {
+			ids[j++] = (GLuint)&queries[i];
+			queries[i].active = GL_TRUE;
+			queries[i].target = 0;
+			queries[i].has_result = GL_FALSE;
+		}
+	}
+}
+
+void glDeleteQueries(GLsizei n, const GLuint *ids) {
+#ifndef SKIP_ERROR_HANDLING
+	if (n < 0) {
+		SET_GL_ERROR(GL_INVALID_VALUE)
+	}
+#endif
+	while (n > 0) {
+		query_object *q = (query_object *)ids[--n];
+		if (q) {
+			// Deleting a running query ends it
+			if (q == active_time_query)
+				active_time_query = NULL;
+			q->active = GL_FALSE;
+			q->target = 0;
+		}
+	}
+}
+
+GLboolean glIsQuery(GLuint id) {
+	query_object *q = (query_object *)id;
+	return q && q->active && q->target;
+}
+
+void glBeginQuery(GLenum target, GLuint id) {
+	query_object *q = (query_object *)id;
+#ifndef SKIP_ERROR_HANDLING
+	if (target != GL_TIME_ELAPSED) {
+		SET_GL_ERROR(GL_INVALID_ENUM)
+	} else if (!q || !q->active || active_time_query || (q->target && q->target != target)) {
+		SET_GL_ERROR(GL_INVALID_OPERATION)
+	}
+#endif
+
+	// Marking the point where previously submitted rendering ends
+	startQueryTimings();
+	placeQueryMarker();
+
+	q->target = target;
+	q->start_marker = query_markers;
+	q->submit_time = 0;
+	q->has_result = GL_FALSE;
+	active_time_query = q;
+}
+
+void glEndQuery(GLenum target) {
+#ifndef SKIP_ERROR_HANDLING
+	if (target != GL_TIME_ELAPSED) {
+		SET_GL_ERROR(GL_INVALID_ENUM)
+	} else if (!active_time_query) {
+		SET_GL_ERROR(GL_INVALID_OPERATION)
+	}
+#endif
+
+	// Marking the point where query rendering ends
+	placeQueryMarker();
+
+	active_time_query->end_marker = query_markers;
+	active_time_query = NULL;
+}
+
+void glQueryCounter(GLuint id, GLenum target) {
+	query_object *q = (query_object *)id;
+#ifndef SKIP_ERROR_HANDLING
+	if (target != GL_TIMESTAMP) {
+		SET_GL_ERROR(GL_INVALID_ENUM)
+	} else if (!q || !q->active || q == active_time_query || (q->target && q->target != target)) {
+		SET_GL_ERROR(GL_INVALID_OPERATION)
+	}
+#endif
+
+	// Marking the point where previously submitted rendering ends
+	startQueryTimings();
+	placeQueryMarker();
+
+	q->target = target;
+	q->start_marker = 0;
+	q->end_marker = query_markers;
+	q->submit_time = sceKernelGetProcessTimeWide();
+	q->has_result = GL_FALSE;
+}
+
+void glGetQueryiv(GLenum target, GLenum pname, GLint *params) {
+#ifndef SKIP_ERROR_HANDLING
+	if (target != GL_TIME_ELAPSED && target != GL_TIMESTAMP) {
+		SET_GL_ERROR(GL_INVALID_ENUM)
+	}
+#endif
+
+	switch (pname) {
+	case GL_CURRENT_QUERY:
+		*params = target == GL_TIME_ELAPSED ? (GLint)active_time_query : 0;
+		break;
+	case GL_QUERY_COUNTER_BITS:
+		*params = 64;
+		break;
+	default:
+		SET_GL_ERROR(GL_INVALID_ENUM)
+	}
+}
+
+void glGetQueryObjectiv(GLuint id, GLenum pname, GLint *params) {
+	uint64_t value;
+	if (getQueryObject(id, pname, &value))
+		*params = value > 0x7FFFFFFF ? 0x7FFFFFFF : value;
+}
+
+void glGetQueryObjectuiv(GLuint id, GLenum pname, GLuint *params) {
+	uint64_t value;
+	if (getQueryObject(id, pname, &value))
+		*params = value > 0xFFFFFFFF ? 0xFFFFFFFF : value;
+}
+
+void glGetQueryObjecti64v(GLuint id, GLenum pname, GLint64 *params) {
+	uint64_t value;
+	if (getQueryObject(id, pname, &value))
+		*params = value;
+}
+
+void glGetQueryObjectui64v(GLuint id, GLenum pname, GLuint64 *params) {
+	getQueryObject(id, pname, params);
+}
@@ -33,8 +33,11 @@ static const struct {
 	{"glAlphaFunc", (void *)glAlphaFunc},
 	{"glAttachShader", (void *)glAttachShader},
 	{"glBegin", (void *)glBegin},
+	{"glBeginQuery", (void *)glBeginQuery},
 	{"glBindAttribLocation", (void *)glBindAttribLocation},
 	{"glBindBuffer", (void *)glBindBuffer},
+	{"glBindBufferBase", (void *)glBindBufferBase},
+	{"glBindBufferRange", (void *)glBindBufferRange},
 	{"glBindFramebuffer", (void *)glBindFramebuffer},
 	{"glBindRenderbuffer", (void *)glBindRenderbuffer},
 	{"glBindTexture", (void *)glBindTexture},
@@ -42,6 +45,7 @@ static const struct {
 	{"glBlendEquationSeparate", (void *)glBlendEquationSeparate},
 	{"glBlendFunc", (void *)glBlendFunc},
 	{"glBlendFuncSeparate", (void *)glBlendFuncSeparate},
+	{"glBlitFramebuffer", (void *)glBlitFramebuffer},
 	{"glBufferData", (void *)glBufferData},
 	{"glBufferSubData", (void *)glBufferSubData},
 	{"glCheckFramebufferStatus", (void *)glCheckFramebufferStatus},
@@ -66,12 +70,15 @@ static const struct {
 	{"glColorTable", (void *)glColorTable},
 	{"glCompileShader", (void *)glCompileShader},
 	{"glCompressedTexImage2D", (void *)glCompressedTexImage2D},
+	{"glCopyTexImage2D", (void *)glCopyTexImage2D},
+	{"glCopyTexSubImage2D", (void *)glCopyTexSubImage2D},
 	{"glCreateProgram", (void *)glCreateProgram},
 	{"glCreateShader", (void *)glCreateShader},
 	{"glCullFace", (void *)glCullFace},
 	{"glDeleteBuffers", (void *)glDeleteBuffers},
 	{"glDeleteFramebuffers", (void *)glDeleteFramebuffers},
 	{"glDeleteProgram", (void *)glDeleteProgram},
+	{"glDeleteQueries", (void *)glDeleteQueries},
 	{"glDeleteRenderbuffers", (void *)glDeleteRenderbuffers},
 	{"glDeleteShader", (void *)glDeleteShader},
 	{"glDeleteTextures", (void *)glDeleteTextures},
@@ -83,11 +90,14 @@ static const struct {
 	{"glDisableClientState", (void *)glDisableClientState},
 	{"glDisableVertexAttribArray", (void *)glDisableVertexAttribArray},
 	{"glDrawArrays", (void *)glDrawArrays},
+	{"glDrawArraysInstanced", (void *)glDrawArraysInstanced},
 	{"glDrawElements", (void *)glDrawElements},
+	{"glDrawElementsInstanced", (void *)glDrawElementsInstanced},
 	{"glEnable", (void *)glEnable},
 	{"glEnableClientState", (void *)glEnableClientState},
 	{"glEnableVertexAttribArray", (void *)glEnableVertexAttribArray},
 	{"glEnd", (void *)glEnd},
+	{"glEndQuery", (void *)glEndQuery},
 	{"glFinish", (void *)glFinish},
 	{"glFlush", (void *)glFlush},
 	{"glFogf", (void *)glFogf},
@@ -101,6 +111,7 @@ static const struct {
 	{"glGenBuffers", (void *)glGenBuffers},
 	{"glGenerateMipmap", (void *)glGenerateMipmap},
 	{"glGenFramebuffers", (void *)glGenFramebuffers},
+	{"glGenQueries", (void *)glGenQueries},
 	{"glGenRenderbuffers", (void *)glGenRenderbuffers},
 	{"glGenTextures", (void *)glGenTextures},
 	{"glGetActiveAttrib", (void *)glGetActiveAttrib},
@@ -110,12 +121,19 @@ static const struct {
 	{"glGetFloatv", (void *)glGetFloatv},
 	{"glGetError", (void *)glGetError},
 	{"glGetIntegerv", (void *)glGetIntegerv},
+	{"glGetProgramBinary", (void *)glGetProgramBinary},
 	{"glGetProgramInfoLog", (void *)glGetProgramInfoLog},
 	{"glGetProgramiv", (void *)glGetProgramiv},
+	{"glGetQueryObjecti64v", (void *)glGetQueryObjecti64v},
+	{"glGetQueryObjectiv", (void *)glGetQueryObjectiv},
+	{"glGetQueryObjectui64v", (void *)glGetQueryObjectui64v},
+	{"glGetQueryObjectuiv", (void *)glGetQueryObjectuiv},
+	{"glGetQueryiv", (void *)glGetQueryiv},
 	{"glGetShaderInfoLog", (void *)glGetShaderInfoLog},
 	{"glGetShaderiv", (void *)glGetShaderiv},
 	{"glGetString", (void *)glGetString},
 	{"glGetStringi", (void *)glGetStringi},
+	{"glGetUniformBlockIndex", (void *)glGetUniformBlockIndex},
 	{"glGetUniformLocation", (void *)glGetUniformLocation},
 	{"glGetVertexAttribfv", (void *)glGetVertexAttribfv},
 	{"glGetVertexAttribiv", (void *)glGetVertexAttribiv},
@@ -124,6 +142,7 @@ static const struct {
 	{"glInterleavedArrays", (void *)glInterleavedArrays},
 	{"glIsEnabled", (void *)glIsEnabled},
 	{"glIsFramebuffer", (void *)glIsFramebuffer},
+	{"glIsQuery", (void *)glIsQuery},
 	{"glIsTexture", (void *)glIsTexture},
 	{"glLightfv", (void *)glLightfv},
 	{"glLineWidth", (void *)glLineWidth},
@@ -133,6 +152,8 @@ static const struct {
 	{"glMaterialfv", (void *)glMaterialfv},
 	{"glMatrixMode", (void *)glMatrixMode},
 	{"glMultMatrixf", (void *)glMultMatrixf},
+	{"glMultiDrawArrays", (void *)glMultiDrawArrays},
+	{"glMultiDrawElements", (void *)glMultiDrawElements},
 	{"glNormal3f", (void *)glNormal3f},
 	{"glNormal3fv", (void *)glNormal3fv},
 	{"glOrtho", (void *)glOrtho},
@@ -140,7 +161,9 @@ static const struct {
 	{"glPolygonMode", (void *)glPolygonMode},
 	{"glPolygonOffset", (void *)glPolygonOffset},
 	{"glPopMatrix", (void *)glPopMatrix},
+	{"glProgramBinary", (void *)glProgramBinary},
 	{"glPushMatrix", (void *)glPushMatrix},
+	{"glQueryCounter", (void *)glQueryCounter},
 	{"glReadPixels", (void *)glReadPixels},
 	{"glReleaseShaderCompiler", (void *)glReleaseShaderCompiler},
 	{"glRenderbufferStorage", (void *)glRenderbufferStorage},
@@ -184,6 +207,7 @@ static const struct {
 	{"glUniform4fv", (void *)glUniform4fv},
 	{"glUniform4i", (void *)glUniform4i},
 	{"glUniform4iv", (void *)glUniform4iv},
+	{"glUniformBlockBinding", (void *)glUniformBlockBinding},
 	{"glUniformMatrix2fv", (void *)glUniformMatrix2fv},
 	{"glUniformMatrix3fv", (void *)glUniformMatrix3fv},
 	{"glUniformMatrix4fv", (void *)glUniformMatrix4fv},
@@ -199,6 +223,7 @@ static const struct {
 	{"glVertexAttrib3fv", (void *)glVertexAttrib3fv},
 	{"glVertexAttrib4f", (void *)glVertexAttrib4f},
 	{"glVertexAttrib4fv", (void *)glVertexAttrib4fv},
+	{"glVertexAttribDivisor", (void *)glVertexAttribDivisor},
 	{"glVertexAttribPointer", (void *)glVertexAttribPointer},
 	{"glVertexPointer", (void *)glVertexPointer},
 	{"glViewport", (void *)glViewport},
@@ -223,6 +248,7 @@ static const struct {
 	{"vglEnd", (void *)vglEnd},
 	{"vglForceAlloc", (void *)vglForceAlloc},
 	{"vglFree", (void *)vglFree},
+	{"vglGetDynamicResolutionScale", (void *)vglGetDynamicResolutionScale},
 	{"vglGetGxmTexture", (void *)vglGetGxmTexture},
 	{"vglGetProcAddress", (void *)vglGetProcAddress},
 	{"vglGetTexDataPointer", (void *)vglGetTexDataPointer},
@@ -232,7 +258,10 @@ static const struct {
 	{"vglInitWithCustomSizes", (void *)vglInitWithCustomSizes},
 	{"vglInitWithCustomThreshold", (void *)vglInitWithCustomThreshold},
 	{"vglMemFree", (void *)vglMemFree},
+	{"vglRenderbufferStorageTransient", (void *)vglRenderbufferStorageTransient},
+	{"vglSetDynamicResolution", (void *)vglSetDynamicResolution},
 	{"vglSetFragmentBufferSize", (void *)vglSetFragmentBufferSize},
+	{"vglSetFramePacing", (void *)vglSetFramePacing},
 	{"vglSetParamBufferSize", (void *)vglSetParamBufferSize},
 	{"vglSetUSSEBufferSize", (void *)vglSetUSSEBufferSize},
 	{"vglSetVDMBufferSize", (void *)vglSetVDMBufferSize},
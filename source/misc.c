@@ -47,41 +47,41 @@ static void update_polygon_offset() {
 	switch (polygon_mode_front) {
 	case SCE_GXM_POLYGON_MODE_TRIANGLE_LINE:
 		if (pol_offset_line)
-			sceGxmSetFrontDepthBias(gxm_context, (int)pol_factor, (int)pol_units);
+			vglSetFrontDepthBias((int)pol_factor, (int)pol_units);
 		else
-			sceGxmSetFrontDepthBias(gxm_context, 0, 0);
+			vglSetFrontDepthBias(0, 0);
 		break;
 	case SCE_GXM_POLYGON_MODE_TRIANGLE_POINT:
 		if (pol_offset_point)
-			sceGxmSetFrontDepthBias(gxm_context, (int)pol_factor, (int)pol_units);
+			vglSetFrontDepthBias((int)pol_factor, (int)pol_units);
 		else
-			sceGxmSetFrontDepthBias(gxm_context, 0, 0);
+			vglSetFrontDepthBias(0, 0);
 		break;
 	case SCE_GXM_POLYGON_MODE_TRIANGLE_FILL:
 		if (pol_offset_fill)
-			sceGxmSetFrontDepthBias(gxm_context, (int)pol_factor, (int)pol_units);
+			vglSetFrontDepthBias((int)pol_factor, (int)pol_units);
 		else
-			sceGxmSetFrontDepthBias(gxm_context, 0, 0);
+			vglSetFrontDepthBias(0, 0);
 		break;
 	}
 	switch (polygon_mode_back) {
 	case SCE_GXM_POLYGON_MODE_TRIANGLE_LINE:
 		if (pol_offset_line)
-			sceGxmSetBackDepthBias(gxm_context, (int)pol_factor, (int)pol_units);
+			vglSetBackDepthBias((int)pol_factor, (int)pol_units);
 		else
-			sceGxmSetBackDepthBias(gxm_context, 0, 0);
+			vglSetBackDepthBias(0, 0);
 		break;
 	case SCE_GXM_POLYGON_MODE_TRIANGLE_POINT:
 		if (pol_offset_point)
-			sceGxmSetBackDepthBias(gxm_context, (int)pol_factor, (int)pol_units);
+			vglSetBackDepthBias((int)pol_factor, (int)pol_units);
 		else
-			sceGxmSetBackDepthBias(gxm_context, 0, 0);
+			vglSetBackDepthBias(0, 0);
 		break;
 	case SCE_GXM_POLYGON_MODE_TRIANGLE_FILL:
 		if (pol_offset_fill)
-			sceGxmSetBackDepthBias(gxm_context, (int)pol_factor, (int)pol_units);
+			vglSetBackDepthBias((int)pol_factor, (int)pol_units);
 		else
-			sceGxmSetBackDepthBias(gxm_context, 0, 0);
+			vglSetBackDepthBias(0, 0);
 		break;
 	}
 }
@@ -91,27 +91,27 @@ void change_cull_mode() {
 	if (cull_face_state) {
 #ifdef HAVE_UNFLIPPED_FBOS
 		if ((gl_front_face == GL_CW) && (gl_cull_mode == GL_BACK))
-			sceGxmSetCullMode(gxm_context, SCE_GXM_CULL_CCW);
+			vglSetCullMode(SCE_GXM_CULL_CCW);
 		else if ((gl_front_face == GL_CCW) && (gl_cull_mode == GL_BACK))
-			sceGxmSetCullMode(gxm_context, SCE_GXM_CULL_CW);
+			vglSetCullMode(SCE_GXM_CULL_CW);
 		else if ((gl_front_face == GL_CCW) && (gl_cull_mode == GL_FRONT))
-			sceGxmSetCullMode(gxm_context, SCE_GXM_CULL_CCW);
+			vglSetCullMode(SCE_GXM_CULL_CCW);
 		else if ((gl_front_face == GL_CW) && (gl_cull_mode == GL_FRONT))
-			sceGxmSetCullMode(gxm_context, SCE_GXM_CULL_CW);
+			vglSetCullMode(SCE_GXM_CULL_CW);
 #else
 		if ((gl_front_face == GL_CW) && (gl_cull_mode == GL_BACK))
-			sceGxmSetCullMode(gxm_context, is_rendering_display ? SCE_GXM_CULL_CCW : SCE_GXM_CULL_CW);
+			vglSetCullMode(is_rendering_display ? SCE_GXM_CULL_CCW : SCE_GXM_CULL_CW);
 		else if ((gl_front_face == GL_CCW) && (gl_cull_mode == GL_BACK))
-			sceGxmSetCullMode(gxm_context, is_rendering_display ? SCE_GXM_CULL_CW : SCE_GXM_CULL_CCW);
+			vglSetCullMode(is_rendering_display ? SCE_GXM_CULL_CW : SCE_GXM_CULL_CCW);
 		else if ((gl_front_face == GL_CCW) && (gl_cull_mode == GL_FRONT))
-			sceGxmSetCullMode(gxm_context, is_rendering_display ? SCE_GXM_CULL_CCW : SCE_GXM_CULL_CW);
+			vglSetCullMode(is_rendering_display ? SCE_GXM_CULL_CCW : SCE_GXM_CULL_CW);
 		else if ((gl_front_face == GL_CW) && (gl_cull_mode == GL_FRONT))
-			sceGxmSetCullMode(gxm_context, is_rendering_display ? SCE_GXM_CULL_CW : SCE_GXM_CULL_CCW);
+			vglSetCullMode(is_rendering_display ? SCE_GXM_CULL_CW : SCE_GXM_CULL_CCW);
 #endif
 		else if (gl_cull_mode == GL_FRONT_AND_BACK)
 			no_polygons_mode = GL_TRUE;
 	} else
-		sceGxmSetCullMode(gxm_context, SCE_GXM_CULL_NONE);
+		vglSetCullMode(SCE_GXM_CULL_NONE);
 }
 
 /*
@@ -139,18 +139,18 @@ void glPolygonMode(GLenum face, GLenum mode) {
 	case GL_FRONT:
 		polygon_mode_front = new_mode;
 		gl_polygon_mode_front = mode;
-		sceGxmSetFrontPolygonMode(gxm_context, new_mode);
+		vglSetFrontPolygonMode(new_mode);
 		break;
 	case GL_BACK:
 		polygon_mode_back = new_mode;
 		gl_polygon_mode_back = mode;
-		sceGxmSetBackPolygonMode(gxm_context, new_mode);
+		vglSetBackPolygonMode(new_mode);
 		break;
 	case GL_FRONT_AND_BACK:
 		polygon_mode_front = polygon_mode_back = new_mode;
 		gl_polygon_mode_front = gl_polygon_mode_back = mode;
-		sceGxmSetFrontPolygonMode(gxm_context, new_mode);
-		sceGxmSetBackPolygonMode(gxm_context, new_mode);
+		vglSetFrontPolygonMode(new_mode);
+		vglSetBackPolygonMode(new_mode);
 		break;
 	default:
 		SET_GL_ERROR(GL_INVALID_ENUM)
@@ -191,7 +191,7 @@ void glViewport(GLint x, GLint y, GLsizei width, GLsizei height) {
 	if (!is_rendering_display)
 		y_scale = -y_scale;
 #endif
-	setViewport(gxm_context, x_port, x_scale, y_port, y_scale, z_port, z_scale);
+	vglSetViewport(x_port, x_scale, y_port, y_scale, z_port, z_scale);
 	gl_viewport.x = x;
 	gl_viewport.y = y;
 	gl_viewport.w = width;
@@ -201,13 +201,13 @@ void glViewport(GLint x, GLint y, GLsizei width, GLsizei height) {
 void glDepthRange(GLdouble nearVal, GLdouble farVal) {
 	z_port = (farVal + nearVal) / 2.0f;
 	z_scale = (farVal - nearVal) / 2.0f;
-	setViewport(gxm_context, x_port, x_scale, y_port, y_scale, z_port, z_scale);
+	vglSetViewport(x_port, x_scale, y_port, y_scale, z_port, z_scale);
 }
 
 void glDepthRangef(GLfloat nearVal, GLfloat farVal) {
 	z_port = (farVal + nearVal) / 2.0f;
 	z_scale = (farVal - nearVal) / 2.0f;
-	setViewport(gxm_context, x_port, x_scale, y_port, y_scale, z_port, z_scale);
+	vglSetViewport(x_port, x_scale, y_port, y_scale, z_port, z_scale);
 }
 
 void glEnable(GLenum cap) {
@@ -235,9 +235,11 @@ void glEnable(GLenum cap) {
 		blend_state = GL_TRUE;
 		break;
 	case GL_SCISSOR_TEST:
-		scissor_test_state = GL_TRUE;
-		sceneReset();
-		update_scissor_test();
+		if (!scissor_test_state) {
+			flush_pending_draws();
+			scissor_test_state = GL_TRUE;
+			update_scissor_test();
+		}
 		break;
 	case GL_CULL_FACE:
 		cull_face_state = GL_TRUE;
@@ -339,9 +341,11 @@ void glDisable(GLenum cap) {
 		blend_state = GL_FALSE;
 		break;
 	case GL_SCISSOR_TEST:
-		scissor_test_state = GL_FALSE;
-		sceneReset();
-		update_scissor_test();
+		if (scissor_test_state) {
+			flush_pending_draws();
+			scissor_test_state = GL_FALSE;
+			update_scissor_test();
+		}
 		break;
 	case GL_CULL_FACE:
 		cull_face_state = GL_FALSE;
@@ -461,11 +465,16 @@ void glClear(GLbitfield mask) {
 	}
 #endif
 
+	// Folding the clear into scene start when nothing has been drawn yet on the target
+	if (sceneClear(mask))
+		return;
+
 	sceneReset();
+	flush_pending_draws();
 
 	// Invalidating viewport and culling
 	invalidate_viewport();
-	sceGxmSetCullMode(gxm_context, SCE_GXM_CULL_NONE);
+	vglSetCullMode(SCE_GXM_CULL_NONE);
 
 	void *fbuffer, *vbuffer;
 
@@ -477,11 +486,11 @@ void glClear(GLbitfield mask) {
 	// Enable disable depth write if both depth mask is true and the depth buffer bit is active.
 	change_depth_write(depth_mask_state && (mask & GL_DEPTH_BUFFER_BIT) ? SCE_GXM_DEPTH_WRITE_ENABLED : SCE_GXM_DEPTH_WRITE_DISABLED);
 
-	sceGxmSetFrontDepthBias(gxm_context, 0, 0);
-	sceGxmSetBackDepthBias(gxm_context, 0, 0);
+	vglSetFrontDepthBias(0, 0);
+	vglSetBackDepthBias(0, 0);
 
-	sceGxmSetFrontPolygonMode(gxm_context, SCE_GXM_POLYGON_MODE_TRIANGLE_FILL);
-	sceGxmSetBackPolygonMode(gxm_context, SCE_GXM_POLYGON_MODE_TRIANGLE_FILL);
+	vglSetFrontPolygonMode(SCE_GXM_POLYGON_MODE_TRIANGLE_FILL);
+	vglSetBackPolygonMode(SCE_GXM_POLYGON_MODE_TRIANGLE_FILL);
 
 	sceGxmSetVertexProgram(gxm_context, clear_vertex_program_patched);
 	sceGxmSetFragmentProgram(gxm_context, clear_fragment_program_patched);
@@ -493,37 +502,37 @@ void glClear(GLbitfield mask) {
 	sceGxmReserveFragmentDefaultUniformBuffer(gxm_context, &fbuffer);
 	sceGxmSetUniformDataF(fbuffer, clear_color, 0, 4, &clear_rgba_val.r);
 
-	sceGxmSetFrontStencilFunc(gxm_context,
+	vglSetFrontStencilFunc(
 		SCE_GXM_STENCIL_FUNC_ALWAYS,
 		SCE_GXM_STENCIL_OP_REPLACE,
 		SCE_GXM_STENCIL_OP_REPLACE,
 		SCE_GXM_STENCIL_OP_REPLACE,
 		0XFF, stencil_mask_front_write & 0xFF);
-	sceGxmSetFrontStencilRef(gxm_context, stencil_value & 0xFF);
+	vglSetFrontStencilRef(stencil_value & 0xFF);
 
-	sceGxmSetBackStencilFunc(gxm_context,
+	vglSetBackStencilFunc(
 		SCE_GXM_STENCIL_FUNC_ALWAYS,
 		SCE_GXM_STENCIL_OP_REPLACE,
 		SCE_GXM_STENCIL_OP_REPLACE,
 		SCE_GXM_STENCIL_OP_REPLACE,
 		0xFF, stencil_mask_back_write & 0xFF);
-	sceGxmSetBackStencilRef(gxm_context, stencil_value & 0xFF);
+	vglSetBackStencilRef(stencil_value & 0xFF);
 
 	if ((mask & GL_COLOR_BUFFER_BIT) == 0) {
 		// Disable fragment program if not clearing color buffer. Depth and stencil clears are unaffected.
-		sceGxmSetFrontFragmentProgramEnable(gxm_context, SCE_GXM_FRAGMENT_PROGRAM_DISABLED);
-		sceGxmSetBackFragmentProgramEnable(gxm_context, SCE_GXM_FRAGMENT_PROGRAM_DISABLED);
+		vglSetFrontFragmentProgramEnable(SCE_GXM_FRAGMENT_PROGRAM_DISABLED);
+		vglSetBackFragmentProgramEnable(SCE_GXM_FRAGMENT_PROGRAM_DISABLED);
 	}
 
 	if ((mask & GL_STENCIL_BUFFER_BIT) == 0) {
 		// Set stencil functions to KEEP if not clearing stencil buffer.
-		sceGxmSetFrontStencilFunc(gxm_context,
+		vglSetFrontStencilFunc(
 			SCE_GXM_STENCIL_FUNC_ALWAYS,
 			SCE_GXM_STENCIL_OP_KEEP,
 			SCE_GXM_STENCIL_OP_KEEP,
 			SCE_GXM_STENCIL_OP_KEEP,
 			0XFF, 0xFF);
-		sceGxmSetBackStencilFunc(gxm_context,
+		vglSetBackStencilFunc(
 			SCE_GXM_STENCIL_FUNC_ALWAYS,
 			SCE_GXM_STENCIL_OP_KEEP,
 			SCE_GXM_STENCIL_OP_KEEP,
@@ -531,6 +540,7 @@ void glClear(GLbitfield mask) {
 			0xFF, 0xFF);
 	}
 
+	vglFlushGxmState();
 	sceGxmDraw(gxm_context, SCE_GXM_PRIMITIVE_TRIANGLE_FAN, SCE_GXM_INDEX_FORMAT_U16, depth_clear_indices, 4);
 
 	validate_depth_test();
@@ -538,11 +548,11 @@ void glClear(GLbitfield mask) {
 
 	change_stencil_settings();
 
-	sceGxmSetFrontPolygonMode(gxm_context, polygon_mode_front);
-	sceGxmSetBackPolygonMode(gxm_context, polygon_mode_back);
+	vglSetFrontPolygonMode(polygon_mode_front);
+	vglSetBackPolygonMode(polygon_mode_back);
 
-	sceGxmSetFrontFragmentProgramEnable(gxm_context, SCE_GXM_FRAGMENT_PROGRAM_ENABLED);
-	sceGxmSetBackFragmentProgramEnable(gxm_context, SCE_GXM_FRAGMENT_PROGRAM_ENABLED);
+	vglSetFrontFragmentProgramEnable(SCE_GXM_FRAGMENT_PROGRAM_ENABLED);
+	vglSetBackFragmentProgramEnable(SCE_GXM_FRAGMENT_PROGRAM_ENABLED);
 
 	update_polygon_offset();
 
@@ -576,8 +586,8 @@ void glLineWidth(GLfloat width) {
 		int_width = 1;
 
 	// Changing line width as requested
-	sceGxmSetFrontPointLineWidth(gxm_context, int_width);
-	sceGxmSetBackPointLineWidth(gxm_context, int_width);
+	vglSetFrontPointLineWidth(int_width);
+	vglSetBackPointLineWidth(int_width);
 }
 
 void glPointSize(GLfloat size) {
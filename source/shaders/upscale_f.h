@@ -0,0 +1,8 @@
+const char *upscale_frag_src =
+	R"(float4 main(
+	float2 vTexcoord : TEXCOORD0,
+	uniform sampler2D tex)
+{
+	return tex2D(tex, vTexcoord);
+}
+)";
@@ -0,0 +1,12 @@
+const char *upscale_vert_src =
+	R"(void main(
+	unsigned int idx : INDEX,
+	float4 out vPosition : POSITION,
+	float2 out vTexcoord : TEXCOORD0)
+{
+	float x = (idx == 1 || idx == 2) ? 1.0f : 0.0f;
+	float y = (idx == 2 || idx == 3) ? 1.0f : 0.0f;
+	vPosition = float4(x * 2.0f - 1.0f, 1.0f - y * 2.0f, 0.5f, 1.0f);
+	vTexcoord = float2(x, y);
+}
+)";
@@ -43,6 +43,8 @@
 #define FRAME_PURGE_FREQ 5 // Frequency in frames for garbage collection
 #define BUFFERS_NUM 256 // Maximum amount of framebuffers objects usable
 #define FFP_VERTEX_ATTRIBS_NUM 8 // Number of attributes used in ffp shaders
+#define UNIFORM_BUFFERS_NUM 14 // Available uniform buffer binding points (sceGxm reserves the last buffer index for default uniforms)
+#define MAX_IDX_NUMBER 12288 // Maximum allowed number of indices per draw call
 #define MEM_ALIGNMENT 16 // Memory alignment
 
 // Internal constants set in bootup phase
@@ -103,30 +105,30 @@ extern GLboolean prim_is_non_native; // Flag for when a primitive not supported
 	switch (x) { \
 	case GL_POINTS: \
 		p = SCE_GXM_PRIMITIVE_POINTS; \
-		sceGxmSetFrontPolygonMode(gxm_context, SCE_GXM_POLYGON_MODE_POINT_01UV); \
-		sceGxmSetBackPolygonMode(gxm_context, SCE_GXM_POLYGON_MODE_POINT_01UV); \
+		vglSetFrontPolygonMode(SCE_GXM_POLYGON_MODE_POINT_01UV); \
+		vglSetBackPolygonMode(SCE_GXM_POLYGON_MODE_POINT_01UV); \
 		break; \
 	case GL_LINES: \
 		if (c % 2) \
 			return; \
 		p = SCE_GXM_PRIMITIVE_LINES; \
-		sceGxmSetFrontPolygonMode(gxm_context, SCE_GXM_POLYGON_MODE_LINE); \
-		sceGxmSetBackPolygonMode(gxm_context, SCE_GXM_POLYGON_MODE_LINE); \
+		vglSetFrontPolygonMode(SCE_GXM_POLYGON_MODE_LINE); \
+		vglSetBackPolygonMode(SCE_GXM_POLYGON_MODE_LINE); \
 		break; \
 	case GL_LINE_STRIP: \
 		if (c < 2) \
 			return; \
 		p = SCE_GXM_PRIMITIVE_LINES; \
-		sceGxmSetFrontPolygonMode(gxm_context, SCE_GXM_POLYGON_MODE_LINE); \
-		sceGxmSetBackPolygonMode(gxm_context, SCE_GXM_POLYGON_MODE_LINE); \
+		vglSetFrontPolygonMode(SCE_GXM_POLYGON_MODE_LINE); \
+		vglSetBackPolygonMode(SCE_GXM_POLYGON_MODE_LINE); \
 		prim_is_non_native = GL_TRUE; \
 		break; \
 	case GL_LINE_LOOP: \
 		if (c < 2) \
 			return; \
 		p = SCE_GXM_PRIMITIVE_LINES; \
-		sceGxmSetFrontPolygonMode(gxm_context, SCE_GXM_POLYGON_MODE_LINE); \
-		sceGxmSetBackPolygonMode(gxm_context, SCE_GXM_POLYGON_MODE_LINE); \
+		vglSetFrontPolygonMode(SCE_GXM_POLYGON_MODE_LINE); \
+		vglSetBackPolygonMode(SCE_GXM_POLYGON_MODE_LINE); \
 		prim_is_non_native = GL_TRUE; \
 		break; \
 	case GL_TRIANGLES: \
@@ -159,24 +161,24 @@ extern GLboolean prim_is_non_native; // Flag for when a primitive not supported
 	switch (x) { \
 	case GL_POINTS: \
 		p = SCE_GXM_PRIMITIVE_POINTS; \
-		sceGxmSetFrontPolygonMode(gxm_context, SCE_GXM_POLYGON_MODE_POINT_01UV); \
-		sceGxmSetBackPolygonMode(gxm_context, SCE_GXM_POLYGON_MODE_POINT_01UV); \
+		vglSetFrontPolygonMode(SCE_GXM_POLYGON_MODE_POINT_01UV); \
+		vglSetBackPolygonMode(SCE_GXM_POLYGON_MODE_POINT_01UV); \
 		break; \
 	case GL_LINES: \
 		p = SCE_GXM_PRIMITIVE_LINES; \
-		sceGxmSetFrontPolygonMode(gxm_context, SCE_GXM_POLYGON_MODE_LINE); \
-		sceGxmSetBackPolygonMode(gxm_context, SCE_GXM_POLYGON_MODE_LINE); \
+		vglSetFrontPolygonMode(SCE_GXM_POLYGON_MODE_LINE); \
+		vglSetBackPolygonMode(SCE_GXM_POLYGON_MODE_LINE); \
 		break; \
 	case GL_LINE_STRIP: \
 		p = SCE_GXM_PRIMITIVE_LINES; \
-		sceGxmSetFrontPolygonMode(gxm_context, SCE_GXM_POLYGON_MODE_LINE); \
-		sceGxmSetBackPolygonMode(gxm_context, SCE_GXM_POLYGON_MODE_LINE); \
+		vglSetFrontPolygonMode(SCE_GXM_POLYGON_MODE_LINE); \
+		vglSetBackPolygonMode(SCE_GXM_POLYGON_MODE_LINE); \
 		prim_is_non_native = GL_TRUE; \
 		break; \
 	case GL_LINE_LOOP: \
 		p = SCE_GXM_PRIMITIVE_LINES; \
-		sceGxmSetFrontPolygonMode(gxm_context, SCE_GXM_POLYGON_MODE_LINE); \
-		sceGxmSetBackPolygonMode(gxm_context, SCE_GXM_POLYGON_MODE_LINE); \
+		vglSetFrontPolygonMode(SCE_GXM_POLYGON_MODE_LINE); \
+		vglSetBackPolygonMode(SCE_GXM_POLYGON_MODE_LINE); \
 		prim_is_non_native = GL_TRUE; \
 		break; \
 	case GL_TRIANGLES: \
@@ -197,11 +199,30 @@ extern GLboolean prim_is_non_native; // Flag for when a primitive not supported
 	}
 #endif
 
+// Emit pending immediate mode draw call, if any
+#define flush_legacy_draw() \
+	if (legacy_draw_count) \
+		flushLegacyDraw();
+
+#ifdef HAVE_DRAW_BATCHING
+// Emit pending batched draw call, if any
+#define flush_draw_batch() \
+	if (draw_batch_idx_count) \
+		flushDrawBatch();
+#else
+#define flush_draw_batch()
+#endif
+
+// Emit any pending draw call before the sceGxm context is used for anything else
+#define flush_pending_draws() \
+	flush_legacy_draw() \
+	flush_draw_batch()
+
 // Restore Polygon mode after a draw call
 #define restore_polygon_mode(p) \
 	if (p == SCE_GXM_PRIMITIVE_LINES || p == SCE_GXM_PRIMITIVE_POINTS) { \
-		sceGxmSetFrontPolygonMode(gxm_context, polygon_mode_front); \
-		sceGxmSetBackPolygonMode(gxm_context, polygon_mode_back); \
+		vglSetFrontPolygonMode(polygon_mode_front); \
+		vglSetBackPolygonMode(polygon_mode_back); \
 	}
 
 // Error set funcs
@@ -264,14 +285,42 @@ typedef enum {
 } texEnvOpMode;
 #endif
 
+// Converted IBO range struct (for non native primitives)
+typedef struct idx_cache {
+	void *ptr;
+	GLenum mode;
+	GLenum type;
+	uint32_t offset;
+	GLsizei count;
+	void *chain;
+} idx_cache;
+
+// Cached IBO range min/max values struct
+typedef struct idx_range {
+	GLenum type;
+	uint32_t offset;
+	GLsizei count;
+	uint32_t min;
+	uint32_t max;
+	void *chain;
+} idx_range;
+
 // VBO struct
 typedef struct {
 	void *ptr;
 	int32_t size;
 	vglMemType type;
 	GLboolean used;
+	idx_cache *idx_cache; // Cached index conversions for non native primitives
+	idx_range *idx_ranges; // Cached index ranges for draws with client side vertex streams
 } gpubuffer;
 
+// Uniform buffer binding point struct
+typedef struct {
+	uint32_t buffer;
+	uint32_t offset;
+} uniform_buffer_binding;
+
 // 3D vertex for position + 4D vertex for RGBA color struct
 typedef struct {
 	vector3f position;
@@ -313,6 +362,7 @@ extern uint16_t *default_line_strips_idx_ptr; // sceGxm mapped progressive indic
 extern int legacy_pool_size; // Mempool size for GL1 immediate draw pipeline
 extern float *legacy_pool; // Mempool for GL1 immediate draw pipeline
 extern float *legacy_pool_ptr; // Current address for vertices population for GL1 immediate draw pipeline
+extern float *legacy_pool_end; // End address of current mempool chunk for GL1 immediate draw pipeline
 extern SceGxmVertexAttribute legacy_vertex_attrib_config[FFP_VERTEX_ATTRIBS_NUM];
 extern SceGxmVertexStream legacy_vertex_stream_config[FFP_VERTEX_ATTRIBS_NUM];
 extern SceGxmVertexAttribute ffp_vertex_attrib_config[FFP_VERTEX_ATTRIBS_NUM];
@@ -426,20 +476,20 @@ extern GLboolean use_vram; // Flag for VRAM usage for allocations
 
 // Macro to mark a pointer or a rendertarget as dirty for garbage collection
 #define markAsDirty(x) frame_purge_list[frame_purge_idx][frame_elem_purge_idx++] = x
-#ifdef HAVE_SHARED_RENDERTARGETS
 typedef struct {
 	SceGxmRenderTarget *rt;
 	int w;
 	int h;
+	SceGxmMultisampleMode msaa;
 	int ref_count;
 	int max_refs;
+	uint32_t mem_size;
+	uint32_t last_used;
+	GLboolean is_uncached; // Flag for render targets created outside of the cache when all its slots are referenced
 } render_target;
 void __markRtAsDirty(render_target *rt);
 #define _markRtAsDirty(x) frame_rt_purge_list[frame_purge_idx][frame_rt_purge_idx++] = x
 #define markRtAsDirty(x) __markRtAsDirty((render_target *)x)
-#else
-#define markRtAsDirty(x) frame_rt_purge_list[frame_purge_idx][frame_rt_purge_idx++] = x
-#endif
 
 extern matrix4x4 mvp_matrix; // ModelViewProjection Matrix
 extern matrix4x4 projection_matrix; // Projection Matrix
@@ -451,6 +501,7 @@ extern GLboolean mvp_modified; // Check if ModelViewProjection matrix needs to b
 extern GLuint cur_program; // Current in use custom program (0 = No custom program)
 extern uint32_t vsync_interval; // Current setting for VSync
 extern uint32_t vertex_array_unit; // Current in-use vertex array buffer unit
+extern uint32_t uniform_buffer_unit; // Current in-use uniform buffer unit
 
 extern GLenum orig_depth_test; // Original depth test state (used for depth test invalidation)
 extern framebuffer *in_use_framebuffer; // Currently in use framebuffer
@@ -459,7 +510,6 @@ extern framebuffer *in_use_framebuffer; // Currently in use framebuffer
 extern SceGxmFragmentProgram *scissor_test_fragment_program; // Scissor test fragment program
 extern vector4f *scissor_test_vertices; // Scissor test region vertices
 extern SceUID scissor_test_vertices_uid; // Scissor test vertices memblock id
-extern GLboolean skip_scene_reset;
 
 extern uint16_t *depth_clear_indices; // Memblock starting address for clear screen indices
 
@@ -479,13 +529,21 @@ void destroyDisplayRenderTarget(void); // Destroys render target for the display
 void initDisplayColorSurfaces(void); // Creates color surfaces for the display
 void termDisplayColorSurfaces(void); // Destroys color surfaces for the display
 void initDepthStencilBuffer(uint32_t w, uint32_t h, SceGxmDepthStencilSurface *surface, void **depth_buffer, void **stencil_buffer); // Creates depth and stencil surfaces
+void initTransientDepthStencilBuffer(uint32_t w, uint32_t h, SceGxmDepthStencilSurface *surface, void **depth_buffer, void **stencil_buffer); // Creates depth and stencil surfaces discarded at scene end on a shared allocation
+void freeDepthStencilBuffer(void *depth_buffer, void *stencil_buffer); // Releases depth and stencil surfaces memory
 void initDepthStencilSurfaces(void); // Creates depth and stencil surfaces for the display
 void termDepthStencilSurfaces(void); // Destroys depth and stencil surfaces for the display
 void startShaderPatcher(void); // Creates a shader patcher instance
 void stopShaderPatcher(void); // Destroys a shader patcher instance
 void waitRenderingDone(void); // Waits for rendering to be finished
 void sceneReset(void); // Resets drawing scene if required
+void sceneBeginFrame(void); // Starts a new frame, if required, without starting a drawing scene
+void sceneInterrupt(void); // Ends current drawing scene to let transfer jobs access its color surface
+GLboolean sceneClear(GLbitfield mask); // Applies a clear at next scene start if possible, returns GL_FALSE if a clear draw is required
 GLboolean startShaderCompiler(void); // Starts a shader compiler instance
+void termDynamicResolution(void); // Releases dynamic resolution mode resources
+void termGpuTimers(void); // Stops GPU timings and timer queries threads
+void getDefaultColorSurface(void **addr, int *width, int *height, SceGxmSyncObject **sync); // Returns the color surface currently backing the default framebuffer (stride is always DISPLAY_STRIDE)
 
 /* tests.c */
 void change_depth_write(SceGxmDepthWriteMode mode); // Changes current in use depth write mode
@@ -497,6 +555,8 @@ GLboolean change_stencil_config(SceGxmStencilOp *cfg, GLenum new_cfg); // Change
 GLboolean change_stencil_func_config(SceGxmStencilFunc *cfg, GLenum new_cfg); // Changes current in use stencil test function value
 void update_alpha_test_settings(void); // Changes current in use alpha test operation value
 void update_scissor_test(void); // Changes current in use scissor test region
+void reset_scissor_test(void); // Sets up scissor test again after a scene start
+void flush_scissor_test(void); // Updates stencil mask for current scissor test region if required
 void resetScissorTestRegion(void); // Resets scissor test region to default values
 void invalidate_viewport(void); // Invalidates currently set viewport
 void validate_viewport(void); // Restores previously invalidated viewport
@@ -509,14 +569,22 @@ void rebuild_frag_shader(SceGxmShaderPatcherId pid, SceGxmFragmentProgram **prog
 /* custom_shaders.c */
 void resetCustomShaders(void); // Resets custom shaders
 void _vglDrawObjects_CustomShadersIMPL(GLboolean implicit_wvp); // vglDrawObjects implementation for rendering with custom shaders
-GLboolean _glDrawElements_CustomShadersIMPL(uint16_t *idx_buf, GLsizei count); // glDrawElements implementation for rendering with custom shaders
-GLboolean _glDrawArrays_CustomShadersIMPL(GLsizei count); // glDrawArrays implementation for rendering with custom shaders
+GLboolean _glDrawElements_CustomShadersIMPL(void *idx_buf, GLenum idx_type, GLsizei count, GLsizei instances, const uint32_t *idx_range); // glDrawElements implementation for rendering with custom shaders (idx_range can be used to pass a precomputed indices range)
+GLboolean _glDrawArrays_CustomShadersIMPL(GLsizei count, GLsizei instances); // glDrawArrays implementation for rendering with custom shaders
 
 /* ffp.c */
-void _glDrawElements_FixedFunctionIMPL(uint16_t *idx_buf, GLsizei count); // glDrawElements implementation for rendering with ffp
+void _glDrawElements_FixedFunctionIMPL(void *idx_buf, GLenum idx_type, GLsizei count, const uint32_t *idx_range); // glDrawElements implementation for rendering with ffp (idx_range can be used to pass a precomputed indices range)
 void _glDrawArrays_FixedFunctionIMPL(GLsizei count); // glDrawArrays implementation for rendering with ffp
 void reload_ffp_shaders(SceGxmVertexAttribute *attrs, SceGxmVertexStream *streams); // Reloads current in use ffp shaders
 void upload_ffp_uniforms(); // Uploads required uniforms for the in use ffp shaders
+extern uint32_t legacy_draw_count; // Number of vertices of the pending immediate mode draw (0 = No pending draw)
+void flushLegacyDraw(void); // Emits the pending immediate mode draw call
+void resetLegacyPool(void); // Allocates the immediate mode mempool for a new frame
+#ifdef HAVE_DRAW_BATCHING
+extern uint32_t draw_batch_idx_count; // Number of indices staged for the pending batched draw (0 = No pending batch)
+GLboolean _glDrawArrays_BatchedIMPL(GLenum mode, GLint first, GLsizei count); // glDrawArrays implementation merging compatible ffp draws into a single one
+void flushDrawBatch(void); // Emits the pending batched draw call
+#endif
 
 /* misc.c */
 void change_cull_mode(void); // Updates current cull mode
@@ -531,5 +599,11 @@ void vgl_debugger_light_draw(uint32_t *fb); // Draws CPU rendered debugger windo
 
 /* vitaGL.c */
 uint8_t *reserve_data_pool(uint32_t size);
+extern uniform_buffer_binding uniform_buffer_bindings[UNIFORM_BUFFERS_NUM]; // Buffers bound to uniform buffer binding points
+void get_index_range(void *idx_buf, GLenum type, GLsizei count, uint32_t *min, uint32_t *max); // Returns the lowest and highest values stored in an index buffer
+void *upload_vertex_range(void *src, uint32_t stride, uint32_t min, uint32_t max); // Copies client side vertices in the given index range to a temporary buffer
+#ifdef HAVE_STATIC_ARRAYS_CACHE
+void tickStaticArraysCache(void); // Advances the static client arrays cache frame counter and evicts unused entries
+#endif
 
 #endif
@@ -26,6 +26,8 @@
 
 #define MAX_CLIP_PLANES_NUM 7 // Maximum number of allowed user defined clip planes
 #define LEGACY_VERTEX_STRIDE 26 // Vertex stride for GL1 immediate draw pipeline
+#define LEGACY_VERTEX_COMPACT_STRIDE 5 // Vertex stride for GL1 immediate draw pipeline with only position and texcoord
+#define LEGACY_VERTEX_COMPACT_COLOR_STRIDE 6 // Vertex stride for GL1 immediate draw pipeline with position, texcoord and U8N color
 #define MAX_LIGHTS_NUM 8 // Maximum number of allowed light sources
 
 // Drawing phases constants for legacy openGL
@@ -143,6 +145,7 @@ extern SceGxmBlendFactor blend_sfactor_rgb; // Current in use RGB source blend f
 extern SceGxmBlendFactor blend_dfactor_rgb; // Current in use RGB dest blend factor
 extern SceGxmBlendFactor blend_sfactor_a; // Current in use A source blend factor
 extern SceGxmBlendFactor blend_dfactor_a; // Current in use A dest blend factor
+extern SceGxmColorMask blend_color_mask; // Current in use color mask (glColorMask)
 
 // Depth Test
 extern GLboolean depth_test_state; // Current state for GL_DEPTH_TEST
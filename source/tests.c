@@ -36,7 +36,8 @@ GLboolean scissor_test_state = GL_FALSE; // Current state for GL_SCISSOR_TEST
 SceGxmFragmentProgram *scissor_test_fragment_program; // Scissor test fragment program
 vector4f *scissor_test_vertices = NULL; // Scissor test region vertices
 SceUID scissor_test_vertices_uid; // Scissor test vertices memblock id
-GLboolean skip_scene_reset = GL_FALSE;
+static GLboolean scissor_mask_dirty = GL_FALSE; // Flag for when the stencil mask needs to be redrawn before next draw call
+static GLboolean is_scissor_mask_full = GL_TRUE; // Flag for when the stencil mask lets every fragment pass
 
 // Stencil Test
 uint8_t stencil_mask_front = 0xFF; // Current in use mask for stencil test on front
@@ -64,14 +65,14 @@ GLboolean alpha_test_state = GL_FALSE; // Current state for GL_ALPHA_TEST
 
 void change_depth_write(SceGxmDepthWriteMode mode) {
 	// Change depth write mode for both front and back primitives
-	sceGxmSetFrontDepthWriteEnable(gxm_context, mode);
-	sceGxmSetBackDepthWriteEnable(gxm_context, mode);
+	vglSetFrontDepthWriteEnable(mode);
+	vglSetBackDepthWriteEnable(mode);
 }
 
 void change_depth_func() {
 	// Setting depth function for both front and back primitives
-	sceGxmSetFrontDepthFunc(gxm_context, depth_test_state ? gxm_depth : SCE_GXM_DEPTH_FUNC_ALWAYS);
-	sceGxmSetBackDepthFunc(gxm_context, depth_test_state ? gxm_depth : SCE_GXM_DEPTH_FUNC_ALWAYS);
+	vglSetFrontDepthFunc(depth_test_state ? gxm_depth : SCE_GXM_DEPTH_FUNC_ALWAYS);
+	vglSetBackDepthFunc(depth_test_state ? gxm_depth : SCE_GXM_DEPTH_FUNC_ALWAYS);
 
 	// Calling an update for the depth write mode
 	change_depth_write(depth_mask_state ? SCE_GXM_DEPTH_WRITE_ENABLED : SCE_GXM_DEPTH_WRITE_DISABLED);
@@ -96,24 +97,24 @@ void validate_depth_test() {
 
 void invalidate_viewport() {
 	// Invalidating current viewport
-	setViewport(gxm_context, fullscreen_x_port, fullscreen_x_scale, fullscreen_y_port, fullscreen_y_scale, fullscreen_z_port, fullscreen_z_scale);
+	vglSetViewport(fullscreen_x_port, fullscreen_x_scale, fullscreen_y_port, fullscreen_y_scale, fullscreen_z_port, fullscreen_z_scale);
 }
 
 void validate_viewport() {
 	// Restoring original viewport
-	setViewport(gxm_context, x_port, x_scale, y_port, y_scale, z_port, z_scale);
+	vglSetViewport(x_port, x_scale, y_port, y_scale, z_port, z_scale);
 }
 
 void change_stencil_settings() {
 	if (stencil_test_state) {
 		// Setting stencil function for both front and back primitives
-		sceGxmSetFrontStencilFunc(gxm_context,
+		vglSetFrontStencilFunc(
 			stencil_func_front,
 			stencil_fail_front,
 			depth_fail_front,
 			depth_pass_front,
 			stencil_mask_front, stencil_mask_front_write);
-		sceGxmSetBackStencilFunc(gxm_context,
+		vglSetBackStencilFunc(
 			stencil_func_back,
 			stencil_fail_back,
 			depth_fail_back,
@@ -121,17 +122,17 @@ void change_stencil_settings() {
 			stencil_mask_back, stencil_mask_back_write);
 
 		// Setting stencil ref for both front and back primitives
-		sceGxmSetFrontStencilRef(gxm_context, stencil_ref_front);
-		sceGxmSetBackStencilRef(gxm_context, stencil_ref_back);
+		vglSetFrontStencilRef(stencil_ref_front);
+		vglSetBackStencilRef(stencil_ref_back);
 
 	} else {
-		sceGxmSetFrontStencilFunc(gxm_context,
+		vglSetFrontStencilFunc(
 			SCE_GXM_STENCIL_FUNC_ALWAYS,
 			SCE_GXM_STENCIL_OP_KEEP,
 			SCE_GXM_STENCIL_OP_KEEP,
 			SCE_GXM_STENCIL_OP_KEEP,
 			0, 0);
-		sceGxmSetBackStencilFunc(gxm_context,
+		vglSetBackStencilFunc(
 			SCE_GXM_STENCIL_FUNC_ALWAYS,
 			SCE_GXM_STENCIL_OP_KEEP,
 			SCE_GXM_STENCIL_OP_KEEP,
@@ -246,8 +247,53 @@ void update_alpha_test_settings() {
 		alpha_op = ALWAYS;
 }
 
+static inline GLboolean is_scissor_region_tile_aligned(void) {
+	// Region clip works at tile granularity, so only tile aligned regions can skip the stencil mask
+	int w = is_rendering_display ? DISPLAY_WIDTH : in_use_framebuffer->width;
+	int h = is_rendering_display ? DISPLAY_HEIGHT : in_use_framebuffer->height;
+	if (!region.w || !region.h)
+		return GL_FALSE;
+	if (is_rendering_display && vglIsSurfaceScaled())
+		return GL_FALSE; // Scaled regions are rounded outwards, so they always need the stencil mask
+	if ((region.x % SCE_GXM_TILE_SIZEX) || (region.y % SCE_GXM_TILE_SIZEY))
+		return GL_FALSE;
+	if (((region.x + region.w) % SCE_GXM_TILE_SIZEX) && (region.x + region.w != w))
+		return GL_FALSE;
+	if (((region.y + region.h) % SCE_GXM_TILE_SIZEY) && (region.y + region.h != h))
+		return GL_FALSE;
+	return GL_TRUE;
+}
+
 void update_scissor_test() {
+	// Performing tile granularity clipping
+	if (scissor_test_state)
+		vglSetRegionClip(SCE_GXM_REGION_CLIP_OUTSIDE, region.x, region.y, region.x + region.w - 1, region.y + region.h - 1);
+	else if (is_rendering_display)
+		vglSetRegionClip(SCE_GXM_REGION_CLIP_OUTSIDE, 0, 0, DISPLAY_WIDTH - 1, DISPLAY_HEIGHT - 1);
+	else
+		vglSetRegionClip(SCE_GXM_REGION_CLIP_OUTSIDE, 0, 0, in_use_framebuffer->width - 1, in_use_framebuffer->height - 1);
+
+	// Non tile aligned regions need the stencil mask too, its update is deferred to next draw call to coalesce consecutive changes
+	if (scissor_test_state && !is_scissor_region_tile_aligned())
+		scissor_mask_dirty = GL_TRUE;
+	else
+		scissor_mask_dirty = !is_scissor_mask_full;
+}
+
+void reset_scissor_test() {
+	// sceGxm resets the stencil mask at scene start
+	is_scissor_mask_full = GL_TRUE;
+	update_scissor_test();
+}
+
+void flush_scissor_test() {
+	if (!scissor_mask_dirty)
+		return;
+	scissor_mask_dirty = GL_FALSE;
+
 	const float scissor_depth = 1.0f;
+	GLboolean needs_mask = scissor_test_state && !is_scissor_region_tile_aligned();
+	flush_pending_draws();
 
 	// Setting current vertex program to clear screen one and fragment program to scissor test one
 	sceGxmSetVertexProgram(gxm_context, clear_vertex_program_patched);
@@ -257,12 +303,12 @@ void update_scissor_test() {
 	invalidate_viewport();
 
 	// Invalidating culling
-	sceGxmSetCullMode(gxm_context, SCE_GXM_CULL_NONE);
+	vglSetCullMode(SCE_GXM_CULL_NONE);
 
 	// Invalidating internal tile based region clip
-	sceGxmSetRegionClip(gxm_context, SCE_GXM_REGION_CLIP_OUTSIDE, 0, 0, is_rendering_display ? DISPLAY_WIDTH : in_use_framebuffer->width - 1, is_rendering_display ? DISPLAY_HEIGHT : in_use_framebuffer->height - 1);
+	vglSetRegionClip(SCE_GXM_REGION_CLIP_OUTSIDE, 0, 0, is_rendering_display ? DISPLAY_WIDTH : in_use_framebuffer->width - 1, is_rendering_display ? DISPLAY_HEIGHT : in_use_framebuffer->height - 1);
 
-	if (scissor_test_state) {
+	if (needs_mask) {
 		// Calculating scissor test region vertices
 		vector4f_convert_to_local_space(scissor_test_vertices, region.x, region.y, region.w, region.h);
 
@@ -272,29 +318,30 @@ void update_scissor_test() {
 		sceGxmSetUniformDataF(vertex_buffer, clear_depth, 0, 1, &scissor_depth);
 
 		// Cleaning stencil surface mask update bit on the whole screen
-		sceGxmSetFrontStencilFunc(gxm_context,
+		vglSetFrontStencilFunc(
 			SCE_GXM_STENCIL_FUNC_NEVER,
 			SCE_GXM_STENCIL_OP_KEEP,
 			SCE_GXM_STENCIL_OP_KEEP,
 			SCE_GXM_STENCIL_OP_KEEP,
 			0, 0);
-		sceGxmSetBackStencilFunc(gxm_context,
+		vglSetBackStencilFunc(
 			SCE_GXM_STENCIL_FUNC_NEVER,
 			SCE_GXM_STENCIL_OP_KEEP,
 			SCE_GXM_STENCIL_OP_KEEP,
 			SCE_GXM_STENCIL_OP_KEEP,
 			0, 0);
+		vglFlushGxmState();
 		sceGxmDraw(gxm_context, SCE_GXM_PRIMITIVE_TRIANGLE_FAN, SCE_GXM_INDEX_FORMAT_U16, depth_clear_indices, 4);
 	}
 
 	// Setting stencil surface mask update bit on the scissor test region
-	sceGxmSetFrontStencilFunc(gxm_context,
+	vglSetFrontStencilFunc(
 		SCE_GXM_STENCIL_FUNC_ALWAYS,
 		SCE_GXM_STENCIL_OP_KEEP,
 		SCE_GXM_STENCIL_OP_KEEP,
 		SCE_GXM_STENCIL_OP_KEEP,
 		0, 0);
-	sceGxmSetBackStencilFunc(gxm_context,
+	vglSetBackStencilFunc(
 		SCE_GXM_STENCIL_FUNC_ALWAYS,
 		SCE_GXM_STENCIL_OP_KEEP,
 		SCE_GXM_STENCIL_OP_KEEP,
@@ -303,13 +350,15 @@ void update_scissor_test() {
 
 	void *vertex_buffer;
 	sceGxmReserveVertexDefaultUniformBuffer(gxm_context, &vertex_buffer);
-	if (scissor_test_state)
+	if (needs_mask)
 		sceGxmSetUniformDataF(vertex_buffer, clear_position, 0, 4, &scissor_test_vertices->x);
 	else
 		sceGxmSetUniformDataF(vertex_buffer, clear_position, 0, 4, &clear_vertices->x);
 	sceGxmSetUniformDataF(vertex_buffer, clear_depth, 0, 1, &scissor_depth);
 
+	vglFlushGxmState();
 	sceGxmDraw(gxm_context, SCE_GXM_PRIMITIVE_TRIANGLE_FAN, SCE_GXM_INDEX_FORMAT_U16, depth_clear_indices, 4);
+	is_scissor_mask_full = !needs_mask;
 
 	// Restoring viewport
 	validate_viewport();
@@ -317,9 +366,9 @@ void update_scissor_test() {
 	// Restoring culling mode
 	change_cull_mode();
 
-	// Reducing GPU workload by performing tile granularity clipping
+	// Restoring tile granularity clipping
 	if (scissor_test_state)
-		sceGxmSetRegionClip(gxm_context, SCE_GXM_REGION_CLIP_OUTSIDE, region.x, region.y, region.x + region.w - 1, region.y + region.h - 1);
+		vglSetRegionClip(SCE_GXM_REGION_CLIP_OUTSIDE, region.x, region.y, region.x + region.w - 1, region.y + region.h - 1);
 
 	// Restoring original stencil test settings
 	change_stencil_settings();
@@ -348,6 +397,9 @@ void glScissor(GLint x, GLint y, GLsizei width, GLsizei height) {
 	}
 #endif
 
+	// Skipping redundant scissor updates
+	scissor_region old_region = region;
+
 	// Converting openGL scissor test region to sceGxm one
 	region.x = x < 0 ? 0 : x;
 	region.w = width;
@@ -375,9 +427,8 @@ void glScissor(GLint x, GLint y, GLsizei width, GLsizei height) {
 	}
 
 	// Updating in use scissor test parameters if GL_SCISSOR_TEST is enabled
-	if (scissor_test_state) {
-		if (!skip_scene_reset)
-			sceneReset();
+	if (scissor_test_state && sceClibMemcmp(&old_region, &region, sizeof(scissor_region))) {
+		flush_pending_draws();
 		update_scissor_test();
 	}
 }
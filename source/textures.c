@@ -464,8 +464,11 @@ void glDeleteTextures(GLsizei n, const GLuint *gl_textures) {
 							fb = active_write_fb;
 						if (fb) {
 							gpu_free_texture(&texture_slots[i]);
-							markAsDirty(fb->depth_buffer_addr);
-							markAsDirty(fb->stencil_buffer_addr);
+							if (fb->depth_buffer_addr) {
+								freeDepthStencilBuffer(fb->depth_buffer_addr, fb->stencil_buffer_addr);
+								fb->depth_buffer_addr = NULL;
+								fb->stencil_buffer_addr = NULL;
+							}
 							if (fb->target) {
 								markRtAsDirty(fb->target);
 								fb->target = NULL;
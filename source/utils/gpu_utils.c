@@ -263,6 +263,20 @@ SceGxmTransferFormat tex_format_to_transfer(SceGxmTextureFormat format) {
 	}
 }
 
+GLboolean tex_format_has_transfer(SceGxmTextureFormat format) {
+	// Checking if the requested texture format can be accessed by sceGxmTransfer jobs
+	switch (format & 0x9F000000) {
+	case SCE_GXM_TEXTURE_BASE_FORMAT_U1U5U5U5:
+	case SCE_GXM_TEXTURE_BASE_FORMAT_U5U6U5:
+	case SCE_GXM_TEXTURE_BASE_FORMAT_U4U4U4U4:
+	case SCE_GXM_TEXTURE_BASE_FORMAT_U8U8U8:
+	case SCE_GXM_TEXTURE_BASE_FORMAT_U8U8U8U8:
+		return GL_TRUE;
+	default:
+		return GL_FALSE;
+	}
+}
+
 int tex_format_to_alignment(SceGxmTextureFormat format) {
 	switch (format & 0x9F000000) {
 	case SCE_GXM_TEXTURE_BASE_FORMAT_UBC3:
@@ -90,6 +90,12 @@ void gpu_fragment_usse_free_mapped(void *addr);
 // Calculate bpp for a requested texture format
 int tex_format_to_bytespp(SceGxmTextureFormat format);
 
+// Calculate sceGxmTransfer format for a requested texture format
+SceGxmTransferFormat tex_format_to_transfer(SceGxmTextureFormat format);
+
+// Check if a texture format has a sceGxmTransfer equivalent
+GLboolean tex_format_has_transfer(SceGxmTextureFormat format);
+
 // Alloc a texture
 void gpu_alloc_texture(uint32_t w, uint32_t h, SceGxmTextureFormat format, const void *data, texture *tex, uint8_t src_bpp, uint32_t (*read_cb)(void *), void (*write_cb)(void *, uint32_t), GLboolean fast_store);
 
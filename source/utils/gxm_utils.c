@@ -24,6 +24,44 @@
 
 #define UNIFORM_CIRCULAR_POOL_SIZE (2 * 1024 * 1024)
 
+// Per face shadowed sceGxm state
+typedef struct {
+	SceGxmDepthFunc depth_func;
+	SceGxmDepthWriteMode depth_write;
+	SceGxmStencilFunc stencil_func;
+	SceGxmStencilOp stencil_fail;
+	SceGxmStencilOp depth_fail;
+	SceGxmStencilOp depth_pass;
+	uint8_t stencil_mask;
+	uint8_t stencil_write_mask;
+	uint32_t stencil_ref;
+	SceGxmPolygonMode polygon_mode;
+	int32_t depth_bias_factor;
+	int32_t depth_bias_units;
+	SceGxmFragmentProgramMode frag_program_mode;
+	uint32_t point_line_width;
+} gxm_face_state;
+
+// Shadowed sceGxm context state
+typedef struct {
+	gxm_face_state face[2];
+	SceGxmCullMode cull_mode;
+	float viewport[6];
+	SceGxmRegionClipMode region_clip_mode;
+	uint32_t region_clip[4];
+} gxm_state;
+
+static gxm_state pending_state; // State requested by vitaGL
+static gxm_state gpu_state; // State last sent to sceGxm
+static uint32_t dirty_state = 0; // Bitmask of states changed since last flush
+static uint32_t valid_state = 0; // Bitmask of states set at least once
+static uint32_t unknown_state = GXM_STATE_ALL; // Bitmask of states whose value on sceGxm side is unknown
+static uint32_t state_calls = 0; // Number of requested state changes
+static uint32_t state_issued = 0; // Number of state changes actually sent to sceGxm
+static GLboolean is_surface_scaled = GL_FALSE; // Flag for when viewport and region clip values are scaled to the render target
+static float surface_scale_x = 1.0f; // Horizontal scale applied to viewport and region clip values
+static float surface_scale_y = 1.0f; // Vertical scale applied to viewport and region clip values
+
 static void *frag_buf = NULL;
 static void *vert_buf = NULL;
 static uint8_t *unif_pool = NULL;
@@ -73,6 +111,276 @@ uint32_t vglReserveVertexUniformBuffer(const SceGxmProgram *p, void **uniformBuf
 	return size;
 }
 
+#define markStateDirty(x) \
+	dirty_state |= (x); \
+	valid_state |= (x); \
+	state_calls++;
+
+void vglSetFrontDepthFunc(SceGxmDepthFunc func) {
+	pending_state.face[0].depth_func = func;
+	markStateDirty(GXM_STATE_DEPTH_FUNC)
+}
+
+void vglSetBackDepthFunc(SceGxmDepthFunc func) {
+	pending_state.face[1].depth_func = func;
+	markStateDirty(GXM_STATE_DEPTH_FUNC << GXM_STATE_BACK_SHIFT)
+}
+
+void vglSetFrontDepthWriteEnable(SceGxmDepthWriteMode mode) {
+	pending_state.face[0].depth_write = mode;
+	markStateDirty(GXM_STATE_DEPTH_WRITE)
+}
+
+void vglSetBackDepthWriteEnable(SceGxmDepthWriteMode mode) {
+	pending_state.face[1].depth_write = mode;
+	markStateDirty(GXM_STATE_DEPTH_WRITE << GXM_STATE_BACK_SHIFT)
+}
+
+static void setStencilFunc(gxm_face_state *s, SceGxmStencilFunc func, SceGxmStencilOp stencilFail, SceGxmStencilOp depthFail, SceGxmStencilOp depthPass, uint8_t compareMask, uint8_t writeMask) {
+	s->stencil_func = func;
+	s->stencil_fail = stencilFail;
+	s->depth_fail = depthFail;
+	s->depth_pass = depthPass;
+	s->stencil_mask = compareMask;
+	s->stencil_write_mask = writeMask;
+}
+
+void vglSetFrontStencilFunc(SceGxmStencilFunc func, SceGxmStencilOp stencilFail, SceGxmStencilOp depthFail, SceGxmStencilOp depthPass, uint8_t compareMask, uint8_t writeMask) {
+	setStencilFunc(&pending_state.face[0], func, stencilFail, depthFail, depthPass, compareMask, writeMask);
+	markStateDirty(GXM_STATE_STENCIL_FUNC)
+}
+
+void vglSetBackStencilFunc(SceGxmStencilFunc func, SceGxmStencilOp stencilFail, SceGxmStencilOp depthFail, SceGxmStencilOp depthPass, uint8_t compareMask, uint8_t writeMask) {
+	setStencilFunc(&pending_state.face[1], func, stencilFail, depthFail, depthPass, compareMask, writeMask);
+	markStateDirty(GXM_STATE_STENCIL_FUNC << GXM_STATE_BACK_SHIFT)
+}
+
+void vglSetFrontStencilRef(uint32_t ref) {
+	pending_state.face[0].stencil_ref = ref;
+	markStateDirty(GXM_STATE_STENCIL_REF)
+}
+
+void vglSetBackStencilRef(uint32_t ref) {
+	pending_state.face[1].stencil_ref = ref;
+	markStateDirty(GXM_STATE_STENCIL_REF << GXM_STATE_BACK_SHIFT)
+}
+
+void vglSetFrontPolygonMode(SceGxmPolygonMode mode) {
+	pending_state.face[0].polygon_mode = mode;
+	markStateDirty(GXM_STATE_POLYGON_MODE)
+}
+
+void vglSetBackPolygonMode(SceGxmPolygonMode mode) {
+	pending_state.face[1].polygon_mode = mode;
+	markStateDirty(GXM_STATE_POLYGON_MODE << GXM_STATE_BACK_SHIFT)
+}
+
+void vglSetFrontDepthBias(int32_t factor, int32_t units) {
+	pending_state.face[0].depth_bias_factor = factor;
+	pending_state.face[0].depth_bias_units = units;
+	markStateDirty(GXM_STATE_DEPTH_BIAS)
+}
+
+void vglSetBackDepthBias(int32_t factor, int32_t units) {
+	pending_state.face[1].depth_bias_factor = factor;
+	pending_state.face[1].depth_bias_units = units;
+	markStateDirty(GXM_STATE_DEPTH_BIAS << GXM_STATE_BACK_SHIFT)
+}
+
+void vglSetFrontFragmentProgramEnable(SceGxmFragmentProgramMode mode) {
+	pending_state.face[0].frag_program_mode = mode;
+	markStateDirty(GXM_STATE_FRAGMENT_PROGRAM_ENABLE)
+}
+
+void vglSetBackFragmentProgramEnable(SceGxmFragmentProgramMode mode) {
+	pending_state.face[1].frag_program_mode = mode;
+	markStateDirty(GXM_STATE_FRAGMENT_PROGRAM_ENABLE << GXM_STATE_BACK_SHIFT)
+}
+
+void vglSetFrontPointLineWidth(uint32_t width) {
+	pending_state.face[0].point_line_width = width;
+	markStateDirty(GXM_STATE_POINT_LINE_WIDTH)
+}
+
+void vglSetBackPointLineWidth(uint32_t width) {
+	pending_state.face[1].point_line_width = width;
+	markStateDirty(GXM_STATE_POINT_LINE_WIDTH << GXM_STATE_BACK_SHIFT)
+}
+
+void vglSetCullMode(SceGxmCullMode mode) {
+	pending_state.cull_mode = mode;
+	markStateDirty(GXM_STATE_CULL_MODE)
+}
+
+void vglSetViewport(float xOffset, float xScale, float yOffset, float yScale, float zOffset, float zScale) {
+	if (is_surface_scaled) {
+		xOffset *= surface_scale_x;
+		xScale *= surface_scale_x;
+		yOffset *= surface_scale_y;
+		yScale *= surface_scale_y;
+	}
+	pending_state.viewport[0] = xOffset;
+	pending_state.viewport[1] = xScale;
+	pending_state.viewport[2] = yOffset;
+	pending_state.viewport[3] = yScale;
+	pending_state.viewport[4] = zOffset;
+	pending_state.viewport[5] = zScale;
+	markStateDirty(GXM_STATE_VIEWPORT)
+}
+
+void vglSetRegionClip(SceGxmRegionClipMode mode, uint32_t xMin, uint32_t yMin, uint32_t xMax, uint32_t yMax) {
+	if (is_surface_scaled) {
+		// Rounding scaled region outwards so that no covered pixel gets clipped
+		xMin = (uint32_t)(xMin * surface_scale_x);
+		yMin = (uint32_t)(yMin * surface_scale_y);
+		xMax = (uint32_t)ceilf((xMax + 1) * surface_scale_x) - 1;
+		yMax = (uint32_t)ceilf((yMax + 1) * surface_scale_y) - 1;
+	}
+	pending_state.region_clip_mode = mode;
+	pending_state.region_clip[0] = xMin;
+	pending_state.region_clip[1] = yMin;
+	pending_state.region_clip[2] = xMax;
+	pending_state.region_clip[3] = yMax;
+	markStateDirty(GXM_STATE_REGION_CLIP)
+}
+
+static void flushFaceState(uint32_t dirty, uint32_t unknown, int is_back) {
+	gxm_face_state *s = &pending_state.face[is_back];
+	gxm_face_state *g = &gpu_state.face[is_back];
+
+	if ((dirty & GXM_STATE_DEPTH_FUNC) && ((unknown & GXM_STATE_DEPTH_FUNC) || s->depth_func != g->depth_func)) {
+		g->depth_func = s->depth_func;
+		if (is_back)
+			sceGxmSetBackDepthFunc(gxm_context, s->depth_func);
+		else
+			sceGxmSetFrontDepthFunc(gxm_context, s->depth_func);
+		state_issued++;
+	}
+	if ((dirty & GXM_STATE_DEPTH_WRITE) && ((unknown & GXM_STATE_DEPTH_WRITE) || s->depth_write != g->depth_write)) {
+		g->depth_write = s->depth_write;
+		if (is_back)
+			sceGxmSetBackDepthWriteEnable(gxm_context, s->depth_write);
+		else
+			sceGxmSetFrontDepthWriteEnable(gxm_context, s->depth_write);
+		state_issued++;
+	}
+	if ((dirty & GXM_STATE_STENCIL_FUNC) && ((unknown & GXM_STATE_STENCIL_FUNC) || s->stencil_func != g->stencil_func || s->stencil_fail != g->stencil_fail || s->depth_fail != g->depth_fail || s->depth_pass != g->depth_pass || s->stencil_mask != g->stencil_mask || s->stencil_write_mask != g->stencil_write_mask)) {
+		setStencilFunc(g, s->stencil_func, s->stencil_fail, s->depth_fail, s->depth_pass, s->stencil_mask, s->stencil_write_mask);
+		if (is_back)
+			sceGxmSetBackStencilFunc(gxm_context, s->stencil_func, s->stencil_fail, s->depth_fail, s->depth_pass, s->stencil_mask, s->stencil_write_mask);
+		else
+			sceGxmSetFrontStencilFunc(gxm_context, s->stencil_func, s->stencil_fail, s->depth_fail, s->depth_pass, s->stencil_mask, s->stencil_write_mask);
+		state_issued++;
+	}
+	if ((dirty & GXM_STATE_STENCIL_REF) && ((unknown & GXM_STATE_STENCIL_REF) || s->stencil_ref != g->stencil_ref)) {
+		g->stencil_ref = s->stencil_ref;
+		if (is_back)
+			sceGxmSetBackStencilRef(gxm_context, s->stencil_ref);
+		else
+			sceGxmSetFrontStencilRef(gxm_context, s->stencil_ref);
+		state_issued++;
+	}
+	if ((dirty & GXM_STATE_POLYGON_MODE) && ((unknown & GXM_STATE_POLYGON_MODE) || s->polygon_mode != g->polygon_mode)) {
+		g->polygon_mode = s->polygon_mode;
+		if (is_back)
+			sceGxmSetBackPolygonMode(gxm_context, s->polygon_mode);
+		else
+			sceGxmSetFrontPolygonMode(gxm_context, s->polygon_mode);
+		state_issued++;
+	}
+	if ((dirty & GXM_STATE_DEPTH_BIAS) && ((unknown & GXM_STATE_DEPTH_BIAS) || s->depth_bias_factor != g->depth_bias_factor || s->depth_bias_units != g->depth_bias_units)) {
+		g->depth_bias_factor = s->depth_bias_factor;
+		g->depth_bias_units = s->depth_bias_units;
+		if (is_back)
+			sceGxmSetBackDepthBias(gxm_context, s->depth_bias_factor, s->depth_bias_units);
+		else
+			sceGxmSetFrontDepthBias(gxm_context, s->depth_bias_factor, s->depth_bias_units);
+		state_issued++;
+	}
+	if ((dirty & GXM_STATE_FRAGMENT_PROGRAM_ENABLE) && ((unknown & GXM_STATE_FRAGMENT_PROGRAM_ENABLE) || s->frag_program_mode != g->frag_program_mode)) {
+		g->frag_program_mode = s->frag_program_mode;
+		if (is_back)
+			sceGxmSetBackFragmentProgramEnable(gxm_context, s->frag_program_mode);
+		else
+			sceGxmSetFrontFragmentProgramEnable(gxm_context, s->frag_program_mode);
+		state_issued++;
+	}
+	if ((dirty & GXM_STATE_POINT_LINE_WIDTH) && ((unknown & GXM_STATE_POINT_LINE_WIDTH) || s->point_line_width != g->point_line_width)) {
+		g->point_line_width = s->point_line_width;
+		if (is_back)
+			sceGxmSetBackPointLineWidth(gxm_context, s->point_line_width);
+		else
+			sceGxmSetFrontPointLineWidth(gxm_context, s->point_line_width);
+		state_issued++;
+	}
+}
+
+void vglFlushGxmState(void) {
+	if (!dirty_state)
+		return;
+
+	// Sending to sceGxm only states whose value differs from the last sent one
+	uint32_t unknown = unknown_state & dirty_state;
+	flushFaceState(dirty_state, unknown, 0);
+	flushFaceState(dirty_state >> GXM_STATE_BACK_SHIFT, unknown >> GXM_STATE_BACK_SHIFT, 1);
+	if ((dirty_state & GXM_STATE_CULL_MODE) && ((unknown & GXM_STATE_CULL_MODE) || pending_state.cull_mode != gpu_state.cull_mode)) {
+		gpu_state.cull_mode = pending_state.cull_mode;
+		sceGxmSetCullMode(gxm_context, pending_state.cull_mode);
+		state_issued++;
+	}
+	if ((dirty_state & GXM_STATE_VIEWPORT) && ((unknown & GXM_STATE_VIEWPORT) || sceClibMemcmp(pending_state.viewport, gpu_state.viewport, sizeof(pending_state.viewport)))) {
+		sceClibMemcpy(gpu_state.viewport, pending_state.viewport, sizeof(pending_state.viewport));
+		setViewport(gxm_context, pending_state.viewport[0], pending_state.viewport[1], pending_state.viewport[2], pending_state.viewport[3], pending_state.viewport[4], pending_state.viewport[5]);
+		state_issued++;
+	}
+	if ((dirty_state & GXM_STATE_REGION_CLIP) && ((unknown & GXM_STATE_REGION_CLIP) || pending_state.region_clip_mode != gpu_state.region_clip_mode || sceClibMemcmp(pending_state.region_clip, gpu_state.region_clip, sizeof(pending_state.region_clip)))) {
+		gpu_state.region_clip_mode = pending_state.region_clip_mode;
+		sceClibMemcpy(gpu_state.region_clip, pending_state.region_clip, sizeof(pending_state.region_clip));
+		sceGxmSetRegionClip(gxm_context, pending_state.region_clip_mode, pending_state.region_clip[0], pending_state.region_clip[1], pending_state.region_clip[2], pending_state.region_clip[3]);
+		state_issued++;
+	}
+	unknown_state &= ~dirty_state;
+	dirty_state = 0;
+}
+
+GLboolean vglHasPendingGxmState(void) {
+	if (!dirty_state)
+		return GL_FALSE;
+
+	// Changed states are pending only if their value differs from the last sent one
+	return (unknown_state & dirty_state) || sceClibMemcmp(&pending_state, &gpu_state, sizeof(gxm_state));
+}
+
+void vglSetSurfaceScale(float x, float y) {
+	is_surface_scaled = x != 1.0f || y != 1.0f;
+	surface_scale_x = x;
+	surface_scale_y = y;
+}
+
+GLboolean vglIsSurfaceScaled(void) {
+	return is_surface_scaled;
+}
+
+void vglInvalidateGxmState(uint32_t mask) {
+	// Forgetting last sent values so that the next flush will send them again
+	unknown_state |= mask;
+
+	// States never set so far keep sceGxm defaults
+	dirty_state |= (mask & valid_state);
+}
+
+void vglGetGxmStateStats(uint32_t *issued, uint32_t *elided) {
+	if (issued)
+		*issued = state_issued;
+	if (elided)
+		*elided = state_calls > state_issued ? state_calls - state_issued : 0;
+}
+
+void vglResetGxmStateStats(void) {
+	state_calls = 0;
+	state_issued = 0;
+}
+
 #ifndef PARANOID
 typedef struct {
 	uint32_t control_words[4];
@@ -32,6 +32,49 @@ void vglRestoreFragmentUniformBuffer(void);
 void vglRestoreVertexUniformBuffer(void);
 void vglSetupUniformCircularPool(void);
 
+// Shadow sceGxm context state dirty bits
+#define GXM_STATE_DEPTH_FUNC (1 << 0)
+#define GXM_STATE_DEPTH_WRITE (1 << 1)
+#define GXM_STATE_STENCIL_FUNC (1 << 2)
+#define GXM_STATE_STENCIL_REF (1 << 3)
+#define GXM_STATE_POLYGON_MODE (1 << 4)
+#define GXM_STATE_DEPTH_BIAS (1 << 5)
+#define GXM_STATE_FRAGMENT_PROGRAM_ENABLE (1 << 6)
+#define GXM_STATE_POINT_LINE_WIDTH (1 << 7)
+#define GXM_STATE_BACK_SHIFT 8 // Back face bits are front face bits shifted by this amount
+#define GXM_STATE_CULL_MODE (1 << 16)
+#define GXM_STATE_VIEWPORT (1 << 17)
+#define GXM_STATE_REGION_CLIP (1 << 18)
+#define GXM_STATE_ALL 0x7FFFF
+
+// Shadow sceGxm context state setters (values are sent to sceGxm only at vglFlushGxmState call)
+void vglSetFrontDepthFunc(SceGxmDepthFunc func);
+void vglSetBackDepthFunc(SceGxmDepthFunc func);
+void vglSetFrontDepthWriteEnable(SceGxmDepthWriteMode mode);
+void vglSetBackDepthWriteEnable(SceGxmDepthWriteMode mode);
+void vglSetFrontStencilFunc(SceGxmStencilFunc func, SceGxmStencilOp stencilFail, SceGxmStencilOp depthFail, SceGxmStencilOp depthPass, uint8_t compareMask, uint8_t writeMask);
+void vglSetBackStencilFunc(SceGxmStencilFunc func, SceGxmStencilOp stencilFail, SceGxmStencilOp depthFail, SceGxmStencilOp depthPass, uint8_t compareMask, uint8_t writeMask);
+void vglSetFrontStencilRef(uint32_t ref);
+void vglSetBackStencilRef(uint32_t ref);
+void vglSetFrontPolygonMode(SceGxmPolygonMode mode);
+void vglSetBackPolygonMode(SceGxmPolygonMode mode);
+void vglSetFrontDepthBias(int32_t factor, int32_t units);
+void vglSetBackDepthBias(int32_t factor, int32_t units);
+void vglSetFrontFragmentProgramEnable(SceGxmFragmentProgramMode mode);
+void vglSetBackFragmentProgramEnable(SceGxmFragmentProgramMode mode);
+void vglSetFrontPointLineWidth(uint32_t width);
+void vglSetBackPointLineWidth(uint32_t width);
+void vglSetCullMode(SceGxmCullMode mode);
+void vglSetViewport(float xOffset, float xScale, float yOffset, float yScale, float zOffset, float zScale);
+void vglSetRegionClip(SceGxmRegionClipMode mode, uint32_t xMin, uint32_t yMin, uint32_t xMax, uint32_t yMax);
+void vglFlushGxmState(void);
+void vglInvalidateGxmState(uint32_t mask);
+GLboolean vglHasPendingGxmState(void);
+
+// Display space viewport and region clip values scaling for render targets smaller than the display
+void vglSetSurfaceScale(float x, float y);
+GLboolean vglIsSurfaceScaled(void);
+
 #ifndef PARANOID
 // Faster variants with stripped error handling
 uint32_t vglGetTexWidth(const SceGxmTexture *texture);
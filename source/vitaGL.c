@@ -22,13 +22,14 @@
 #include "vitaGL.h"
 #include "shared.h"
 #include "texture_callbacks.h"
+#ifdef __ARM_NEON__
+#include <arm_neon.h>
+#endif
 
 // Shaders
 #include "shaders/clear_f.h"
 #include "shaders/clear_v.h"
 
-#define MAX_IDX_NUMBER 12288 // Maximum allowed number of indices per draw call
-
 #ifdef HAVE_SOFTFP_ABI
 __attribute__((naked)) void sceGxmSetViewport_sfp(SceGxmContext *context, float xOffset, float xScale, float yOffset, float yScale, float zOffset, float zScale) {
 	asm volatile(
@@ -94,11 +95,13 @@ void *index_object;
 
 extern GLboolean use_vram_for_usse;
 
-static SceGxmColorMask blend_color_mask = SCE_GXM_COLOR_MASK_ALL; // Current in-use color mask (glColorMask)
+SceGxmColorMask blend_color_mask = SCE_GXM_COLOR_MASK_ALL; // Current in-use color mask (glColorMask)
 static SceGxmBlendFunc blend_func_rgb = SCE_GXM_BLEND_FUNC_ADD; // Current in-use RGB blend func
 static SceGxmBlendFunc blend_func_a = SCE_GXM_BLEND_FUNC_ADD; // Current in-use A blend func
 uint32_t vertex_array_unit = 0; // Current in-use vertex array buffer unit
 static uint32_t index_array_unit = 0; // Current in-use element array buffer unit
+uint32_t uniform_buffer_unit = 0; // Current in-use uniform buffer unit
+uniform_buffer_binding uniform_buffer_bindings[UNIFORM_BUFFERS_NUM]; // Buffers bound to uniform buffer binding points
 uint16_t *default_idx_ptr; // sceGxm mapped progressive indices buffer
 uint16_t *default_quads_idx_ptr; // sceGxm mapped progressive indices buffer for quads
 uint16_t *default_line_strips_idx_ptr; // sceGxm mapped progressive indices buffer for line strips
@@ -440,6 +443,12 @@ void vglEnd(void) {
 	sceGxmShaderPatcherUnregisterProgram(gxm_shader_patcher, clear_vertex_id);
 	sceGxmShaderPatcherUnregisterProgram(gxm_shader_patcher, clear_fragment_id);
 
+	// Releasing dynamic resolution mode resources
+	termDynamicResolution();
+
+	// Stopping GPU timings threads
+	termGpuTimers();
+
 	// Terminating shader patcher
 	stopShaderPatcher();
 
@@ -500,11 +509,456 @@ void glBindBuffer(GLenum target, GLuint buffer) {
 	case GL_ELEMENT_ARRAY_BUFFER:
 		index_array_unit = buffer;
 		break;
+	case GL_UNIFORM_BUFFER:
+		uniform_buffer_unit = buffer;
+		break;
 	default:
 		SET_GL_ERROR(GL_INVALID_ENUM)
 	}
 }
 
+void glBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+#ifndef SKIP_ERROR_HANDLING
+	if (target != GL_UNIFORM_BUFFER) {
+		SET_GL_ERROR(GL_INVALID_ENUM)
+	} else if (index >= UNIFORM_BUFFERS_NUM || offset < 0 || (buffer && size <= 0)) {
+		SET_GL_ERROR(GL_INVALID_VALUE)
+	}
+#endif
+	uniform_buffer_unit = buffer;
+	uniform_buffer_bindings[index].buffer = buffer;
+	uniform_buffer_bindings[index].offset = offset;
+}
+
+void glBindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+#ifndef SKIP_ERROR_HANDLING
+	if (target != GL_UNIFORM_BUFFER) {
+		SET_GL_ERROR(GL_INVALID_ENUM)
+	} else if (index >= UNIFORM_BUFFERS_NUM) {
+		SET_GL_ERROR(GL_INVALID_VALUE)
+	}
+#endif
+	uniform_buffer_unit = buffer;
+	uniform_buffer_bindings[index].buffer = buffer;
+	uniform_buffer_bindings[index].offset = 0;
+}
+
+static void scan_index_range_u16(uint16_t *idx_buf, GLsizei count, uint32_t *min, uint32_t *max) {
+	uint16_t lo = 0xFFFF, hi = 0;
+	int i = 0;
+#ifdef __ARM_NEON__
+	// Processing 8 indices per iteration
+	if (count >= 8) {
+		uint16x8_t vlo = vdupq_n_u16(0xFFFF);
+		uint16x8_t vhi = vdupq_n_u16(0);
+		for (; i <= count - 8; i += 8) {
+			uint16x8_t v = vld1q_u16(&idx_buf[i]);
+			vlo = vminq_u16(vlo, v);
+			vhi = vmaxq_u16(vhi, v);
+		}
+		uint16x4_t dlo = vmin_u16(vget_low_u16(vlo), vget_high_u16(vlo));
+		uint16x4_t dhi = vmax_u16(vget_low_u16(vhi), vget_high_u16(vhi));
+		dlo = vpmin_u16(dlo, dlo);
+		dhi = vpmax_u16(dhi, dhi);
+		dlo = vpmin_u16(dlo, dlo);
+		dhi = vpmax_u16(dhi, dhi);
+		lo = vget_lane_u16(dlo, 0);
+		hi = vget_lane_u16(dhi, 0);
+	}
+#endif
+	for (; i < count; i++) {
+		if (idx_buf[i] < lo)
+			lo = idx_buf[i];
+		if (idx_buf[i] > hi)
+			hi = idx_buf[i];
+	}
+	*min = lo;
+	*max = hi;
+}
+
+static void scan_index_range_u32(uint32_t *idx_buf, GLsizei count, uint32_t *min, uint32_t *max) {
+	uint32_t lo = 0xFFFFFFFF, hi = 0;
+	int i = 0;
+#ifdef __ARM_NEON__
+	// Processing 4 indices per iteration
+	if (count >= 4) {
+		uint32x4_t vlo = vdupq_n_u32(0xFFFFFFFF);
+		uint32x4_t vhi = vdupq_n_u32(0);
+		for (; i <= count - 4; i += 4) {
+			uint32x4_t v = vld1q_u32(&idx_buf[i]);
+			vlo = vminq_u32(vlo, v);
+			vhi = vmaxq_u32(vhi, v);
+		}
+		uint32x2_t dlo = vmin_u32(vget_low_u32(vlo), vget_high_u32(vlo));
+		uint32x2_t dhi = vmax_u32(vget_low_u32(vhi), vget_high_u32(vhi));
+		dlo = vpmin_u32(dlo, dlo);
+		dhi = vpmax_u32(dhi, dhi);
+		lo = vget_lane_u32(dlo, 0);
+		hi = vget_lane_u32(dhi, 0);
+	}
+#endif
+	for (; i < count; i++) {
+		if (idx_buf[i] < lo)
+			lo = idx_buf[i];
+		if (idx_buf[i] > hi)
+			hi = idx_buf[i];
+	}
+	*min = lo;
+	*max = hi;
+}
+
+#define IDX_RANGES_SIZE 16 // Maximum number of cached index ranges per buffer
+
+void get_index_range(void *idx_buf, GLenum type, GLsizei count, uint32_t *min, uint32_t *max) {
+	// Checking if the range for the bound IBO has already been calculated since last buffer upload
+	gpubuffer *gpu_buf = (gpubuffer *)index_array_unit;
+	uint32_t offset;
+	idx_range *r = NULL, *prev = NULL, *last_prev = NULL;
+	int cached = 0;
+	if (gpu_buf) {
+		offset = (uint8_t *)idx_buf - (uint8_t *)gpu_buf->ptr;
+		r = gpu_buf->idx_ranges;
+		while (r) {
+			if (r->type == type && r->offset == offset && r->count == count) {
+				// Moving the entry to the list head so that least recently used entries get recycled first
+				if (prev) {
+					prev->chain = r->chain;
+					r->chain = gpu_buf->idx_ranges;
+					gpu_buf->idx_ranges = r;
+				}
+				*min = r->min;
+				*max = r->max;
+				return;
+			}
+			last_prev = prev;
+			prev = r;
+			r = (idx_range *)r->chain;
+			cached++;
+		}
+	}
+
+	// Scanning the index buffer
+	switch (type) {
+	case GL_UNSIGNED_BYTE:
+		{
+			uint8_t *idx = (uint8_t *)idx_buf;
+			uint8_t lo = 0xFF, hi = 0;
+			for (int i = 0; i < count; i++) {
+				if (idx[i] < lo)
+					lo = idx[i];
+				if (idx[i] > hi)
+					hi = idx[i];
+			}
+			*min = lo;
+			*max = hi;
+		}
+		break;
+	case GL_UNSIGNED_INT:
+		scan_index_range_u32((uint32_t *)idx_buf, count, min, max);
+		break;
+	default:
+		scan_index_range_u16((uint16_t *)idx_buf, count, min, max);
+		break;
+	}
+
+	// Empty index buffers reference no vertex, so we report a single vertex range
+	if (*min > *max) {
+		*min = 0;
+		*max = 0;
+	}
+
+	// Caching the result for the bound IBO, recycling least recently used entry if the cache is full
+	if (gpu_buf) {
+		if (cached >= IDX_RANGES_SIZE) {
+			r = prev;
+			if (last_prev)
+				last_prev->chain = NULL;
+			else
+				gpu_buf->idx_ranges = NULL;
+		} else
+			r = (idx_range *)vgl_malloc(sizeof(idx_range), VGL_MEM_EXTERNAL);
+		if (r) {
+			r->type = type;
+			r->offset = offset;
+			r->count = count;
+			r->min = *min;
+			r->max = *max;
+			r->chain = gpu_buf->idx_ranges;
+			gpu_buf->idx_ranges = r;
+		}
+	}
+}
+
+#ifdef HAVE_STATIC_ARRAYS_CACHE
+#define STATIC_ARRAYS_CACHE_SIZE 256 // Number of slots of the static client arrays cache
+#define STATIC_ARRAYS_PROMOTION_FRAMES 3 // Number of consecutive frames a client array must stay unchanged to be promoted
+#define STATIC_ARRAYS_EVICTION_FRAMES 60 // Number of frames a promoted client array can stay unused before being evicted
+
+// Static client array cache entry struct
+typedef struct {
+	uint32_t addr;
+	uint32_t size;
+	uint32_t hash;
+	uint32_t last_frame;
+	uint32_t frames;
+	void *ptr;
+} static_array;
+
+static static_array static_arrays[STATIC_ARRAYS_CACHE_SIZE]; // Static client arrays cache
+static uint32_t static_arrays_frame = 0; // Frame counter for the static client arrays cache
+static uint32_t static_arrays_hits = 0; // Number of uploads served by a promoted client array
+static uint32_t static_arrays_misses = 0; // Number of uploads requiring a temporary copy
+static uint32_t static_arrays_promotions = 0; // Number of client arrays promoted to persistent GPU buffers
+static uint32_t static_arrays_evictions = 0; // Number of promoted client arrays evicted from the cache
+
+static uint32_t hash_client_array(uint8_t *data, uint32_t size) {
+	// FNV-1a over 32 bit words when possible
+	uint32_t hash = 2166136261u;
+	uint32_t i = 0;
+	if (!((uint32_t)data & 3)) {
+		uint32_t *words = (uint32_t *)data;
+		for (; i < size >> 2; i++) {
+			hash = (hash ^ words[i]) * 16777619u;
+		}
+		i <<= 2;
+	}
+	for (; i < size; i++) {
+		hash = (hash ^ data[i]) * 16777619u;
+	}
+	return hash;
+}
+
+static void *get_static_array(uint8_t *data, uint32_t size) {
+	static_array *a = &static_arrays[(((uint32_t)data >> 4) ^ size) % STATIC_ARRAYS_CACHE_SIZE];
+	uint32_t hash = hash_client_array(data, size);
+
+	// Replacing the entry if the slot is used by another client array or if its content changed
+	if (a->addr != (uint32_t)data || a->size != size || a->hash != hash) {
+		if (a->ptr) {
+			markAsDirty(a->ptr);
+			a->ptr = NULL;
+			static_arrays_evictions++;
+		}
+		a->addr = (uint32_t)data;
+		a->size = size;
+		a->hash = hash;
+		a->frames = 0;
+		a->last_frame = static_arrays_frame;
+		static_arrays_misses++;
+		return NULL;
+	}
+
+	// Promoting the client array to a persistent GPU buffer if unchanged for enough frames
+	if (a->last_frame != static_arrays_frame) {
+		a->last_frame = static_arrays_frame;
+		a->frames++;
+	}
+	if (!a->ptr && a->frames >= STATIC_ARRAYS_PROMOTION_FRAMES) {
+		a->ptr = gpu_alloc_mapped(size, VGL_MEM_VRAM);
+		if (a->ptr) {
+			sceClibMemcpy(a->ptr, data, size);
+			static_arrays_promotions++;
+		}
+	}
+
+	if (a->ptr)
+		static_arrays_hits++;
+	else
+		static_arrays_misses++;
+	return a->ptr;
+}
+
+void tickStaticArraysCache(void) {
+	static_arrays_frame++;
+
+	// Evicting promoted client arrays not used for a while
+	for (int i = 0; i < STATIC_ARRAYS_CACHE_SIZE; i++) {
+		static_array *a = &static_arrays[i];
+		if (a->ptr && static_arrays_frame - a->last_frame > STATIC_ARRAYS_EVICTION_FRAMES) {
+			markAsDirty(a->ptr);
+			a->ptr = NULL;
+			a->addr = 0;
+			a->size = 0;
+			static_arrays_evictions++;
+		}
+	}
+}
+#endif
+
+void *upload_vertex_range(void *src, uint32_t stride, uint32_t min, uint32_t max) {
+	// Clamping empty ranges to avoid size underflows
+	if (min > max)
+		min = max;
+
+	// Skipping vertices below the lowest index while keeping the stream base 4 bytes aligned
+	uint32_t skip = (min * stride) & ~3;
+	uint32_t size = (max + 1) * stride - skip;
+#ifdef HAVE_STATIC_ARRAYS_CACHE
+	uint8_t *ptr = get_static_array((uint8_t *)src + skip, size);
+	if (ptr)
+		return ptr - skip;
+	ptr = gpu_alloc_mapped_temp(size);
+#else
+	uint8_t *ptr = gpu_alloc_mapped_temp(size);
+#endif
+	sceClibMemcpy(ptr, (uint8_t *)src + skip, size);
+	return ptr - skip;
+}
+
+// Size of an index once converted to a format supported by sceGxm
+#define gxm_idx_size(type) ((type) == GL_UNSIGNED_INT ? sizeof(uint32_t) : sizeof(uint16_t))
+
+// Size of an index as provided by the application
+#define gl_idx_size(type) ((type) == GL_UNSIGNED_INT ? sizeof(uint32_t) : ((type) == GL_UNSIGNED_BYTE ? sizeof(uint8_t) : sizeof(uint16_t)))
+
+static inline GLsizei get_converted_idx_count(GLenum mode, GLsizei count) {
+	switch (mode) {
+	case GL_QUADS:
+		return (count / 2) * 3;
+	case GL_LINE_STRIP:
+		return (count - 1) * 2;
+	case GL_LINE_LOOP:
+		return count * 2;
+	default:
+		return count;
+	}
+}
+
+#define convert_indices_by_type(dst, src, mode, count) \
+	switch (mode) { \
+	case GL_QUADS: \
+		for (i = 0; i < count / 4; i++) { \
+			dst[i * 6] = src[i * 4]; \
+			dst[i * 6 + 1] = src[i * 4 + 1]; \
+			dst[i * 6 + 2] = src[i * 4 + 3]; \
+			dst[i * 6 + 3] = src[i * 4 + 1]; \
+			dst[i * 6 + 4] = src[i * 4 + 2]; \
+			dst[i * 6 + 5] = src[i * 4 + 3]; \
+		} \
+		break; \
+	case GL_LINE_STRIP: \
+		for (i = 0; i < count - 1; i++) { \
+			dst[i * 2] = src[i]; \
+			dst[i * 2 + 1] = src[i + 1]; \
+		} \
+		break; \
+	case GL_LINE_LOOP: \
+		for (i = 0; i < count - 1; i++) { \
+			dst[i * 2] = src[i]; \
+			dst[i * 2 + 1] = src[i + 1]; \
+		} \
+		dst[i * 2] = src[count - 1]; \
+		dst[i * 2 + 1] = src[0]; \
+		break; \
+	default: \
+		for (i = 0; i < count; i++) \
+			dst[i] = src[i]; \
+		break; \
+	}
+
+static void convert_indices(void *dst, void *src, GLenum mode, GLenum type, GLsizei count) {
+	int i;
+	switch (type) {
+	case GL_UNSIGNED_BYTE:
+		{
+			// Widening 8 bit indices since sceGxm supports only 16 and 32 bit indices
+			uint16_t *d = (uint16_t *)dst;
+			uint8_t *s = (uint8_t *)src;
+			convert_indices_by_type(d, s, mode, count)
+		}
+		break;
+	case GL_UNSIGNED_INT:
+		if (mode != GL_QUADS && mode != GL_LINE_STRIP && mode != GL_LINE_LOOP)
+			sceClibMemcpy(dst, src, count * sizeof(uint32_t));
+		else {
+			uint32_t *d = (uint32_t *)dst;
+			uint32_t *s = (uint32_t *)src;
+			convert_indices_by_type(d, s, mode, count)
+		}
+		break;
+	default:
+		if (mode != GL_QUADS && mode != GL_LINE_STRIP && mode != GL_LINE_LOOP)
+			sceClibMemcpy(dst, src, count * sizeof(uint16_t));
+		else {
+			uint16_t *d = (uint16_t *)dst;
+			uint16_t *s = (uint16_t *)src;
+			convert_indices_by_type(d, s, mode, count)
+		}
+		break;
+	}
+}
+
+#define IDX_CACHE_SIZE 8 // Maximum number of cached index conversions per buffer
+static void *get_cached_indices(gpubuffer *gpu_buf, GLenum mode, GLenum type, uint32_t offset, GLsizei count) {
+	// Checking if this range has already been converted since last buffer upload
+	idx_cache *c = gpu_buf->idx_cache, *prev = NULL, *last_prev = NULL;
+	int cached = 0;
+	while (c) {
+		if (c->mode == mode && c->type == type && c->offset == offset && c->count == count) {
+			// Moving the entry to the list head so that least recently used entries get evicted first
+			if (prev) {
+				prev->chain = c->chain;
+				c->chain = gpu_buf->idx_cache;
+				gpu_buf->idx_cache = c;
+			}
+			return c->ptr;
+		}
+		last_prev = prev;
+		prev = c;
+		c = (idx_cache *)c->chain;
+		cached++;
+	}
+
+	// Evicting least recently used entry if the cache is full
+	if (cached >= IDX_CACHE_SIZE) {
+		markAsDirty(prev->ptr);
+		vgl_free(prev);
+		if (last_prev)
+			last_prev->chain = NULL;
+		else
+			gpu_buf->idx_cache = NULL;
+	}
+
+	// Converting the requested range and caching it
+	c = (idx_cache *)vgl_malloc(sizeof(idx_cache), VGL_MEM_EXTERNAL);
+	if (!c)
+		return NULL;
+	c->ptr = gpu_alloc_mapped(get_converted_idx_count(mode, count) * gxm_idx_size(type), VGL_MEM_VRAM);
+	if (!c->ptr) {
+		vgl_free(c);
+		return NULL;
+	}
+	convert_indices(c->ptr, (uint8_t *)gpu_buf->ptr + offset, mode, type, count);
+	c->mode = mode;
+	c->type = type;
+	c->offset = offset;
+	c->count = count;
+	c->chain = gpu_buf->idx_cache;
+	gpu_buf->idx_cache = c;
+	return c->ptr;
+}
+
+static void purge_idx_cache(gpubuffer *gpu_buf) {
+	// Cached index buffers may still be in use by the GPU, so we mark them for deletion
+	idx_cache *c = gpu_buf->idx_cache;
+	while (c) {
+		idx_cache *next = (idx_cache *)c->chain;
+		markAsDirty(c->ptr);
+		vgl_free(c);
+		c = next;
+	}
+	gpu_buf->idx_cache = NULL;
+
+	// Cached index ranges are CPU side only, so we can free them straight
+	idx_range *r = gpu_buf->idx_ranges;
+	while (r) {
+		idx_range *next = (idx_range *)r->chain;
+		vgl_free(r);
+		r = next;
+	}
+	gpu_buf->idx_ranges = NULL;
+}
+
 void glDeleteBuffers(GLsizei n, const GLuint *gl_buffers) {
 #ifndef SKIP_ERROR_HANDLING
 	if (n < 0) {
@@ -522,7 +976,16 @@ void glDeleteBuffers(GLsizei n, const GLuint *gl_buffers) {
 				else
 					vgl_free(gpu_buf->ptr);
 			}
+			purge_idx_cache(gpu_buf);
 			vgl_free(gpu_buf);
+
+			// Unbinding the buffer from uniform buffer binding points
+			for (i = 0; i < UNIFORM_BUFFERS_NUM; i++) {
+				if (uniform_buffer_bindings[i].buffer == gl_buffers[j])
+					uniform_buffer_bindings[i].buffer = 0;
+			}
+			if (uniform_buffer_unit == gl_buffers[j])
+				uniform_buffer_unit = 0;
 		}
 	}
 }
@@ -536,6 +999,9 @@ void glBufferData(GLenum target, GLsizei size, const GLvoid *data, GLenum usage)
 	case GL_ELEMENT_ARRAY_BUFFER:
 		gpu_buf = (gpubuffer *)index_array_unit;
 		break;
+	case GL_UNIFORM_BUFFER:
+		gpu_buf = (gpubuffer *)uniform_buffer_unit;
+		break;
 	default:
 		SET_GL_ERROR(GL_INVALID_ENUM)
 	}
@@ -565,6 +1031,7 @@ void glBufferData(GLenum target, GLsizei size, const GLvoid *data, GLenum usage)
 		else
 			vgl_free(gpu_buf->ptr);
 	}
+	purge_idx_cache(gpu_buf);
 
 	// Allocating a new buffer
 	gpu_buf->ptr = gpu_alloc_mapped(size, gpu_buf->type);
@@ -591,6 +1058,9 @@ void glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void
 	case GL_ELEMENT_ARRAY_BUFFER:
 		gpu_buf = (gpubuffer *)index_array_unit;
 		break;
+	case GL_UNIFORM_BUFFER:
+		gpu_buf = (gpubuffer *)uniform_buffer_unit;
+		break;
 	default:
 		SET_GL_ERROR(GL_INVALID_ENUM)
 	}
@@ -619,6 +1089,7 @@ void glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void
 	else
 		vgl_free(ptr);
 	gpu_buf->used = GL_FALSE;
+	purge_idx_cache(gpu_buf);
 }
 
 void glGetBufferParameteriv(GLenum target, GLenum pname, GLint *params) {
@@ -630,6 +1101,9 @@ void glGetBufferParameteriv(GLenum target, GLenum pname, GLint *params) {
 	case GL_ELEMENT_ARRAY_BUFFER:
 		gpu_buf = (gpubuffer *)index_array_unit;
 		break;
+	case GL_UNIFORM_BUFFER:
+		gpu_buf = (gpubuffer *)uniform_buffer_unit;
+		break;
 	default:
 		SET_GL_ERROR(GL_INVALID_ENUM)
 	}
@@ -965,17 +1439,121 @@ void glColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha
 
 extern GLboolean skip_this_draw;
 
-void glDrawArrays(GLenum mode, GLint first, GLsizei count) {
+static inline GLboolean is_prim_mode_legal(GLenum mode) {
+	switch (mode) {
+	case GL_POINTS:
+	case GL_LINES:
+	case GL_LINE_STRIP:
+	case GL_LINE_LOOP:
+	case GL_TRIANGLES:
+	case GL_TRIANGLE_STRIP:
+	case GL_TRIANGLE_FAN:
+	case GL_QUADS:
+		return GL_TRUE;
+	default:
+		return GL_FALSE;
+	}
+}
+
+static inline GLboolean is_prim_count_legal(GLenum mode, GLsizei count) {
+	switch (mode) {
+	case GL_LINES:
+		return count > 0 && !(count % 2);
+	case GL_LINE_STRIP:
+	case GL_LINE_LOOP:
+		return count >= 2;
+	case GL_TRIANGLES:
+		return count > 0 && !(count % 3);
+	case GL_TRIANGLE_STRIP:
+	case GL_TRIANGLE_FAN:
+		return count >= 3;
+	case GL_QUADS:
+		return count > 0 && !(count % 4);
+	default:
+		return count > 0;
+	}
+}
+
+// Primitive lists can be merged by concatenating their vertices
+#define is_prim_list(mode) ((mode) == GL_POINTS || (mode) == GL_LINES || (mode) == GL_TRIANGLES || (mode) == GL_QUADS)
+
+static uint16_t *get_arrays_indices(GLenum mode, GLint first, GLsizei *count) {
+	uint16_t *ptr;
+	switch (mode) {
+	case GL_QUADS:
+		ptr = default_quads_idx_ptr + (first / 2) * 3;
+		*count = (*count / 2) * 3;
+		break;
+	case GL_LINE_STRIP:
+		ptr = default_line_strips_idx_ptr + first * 2;
+		*count = (*count - 1) * 2;
+		break;
+	case GL_LINE_LOOP:
+		ptr = gpu_alloc_mapped_temp(*count * 2 * sizeof(uint16_t));
+		sceClibMemcpy(ptr, default_line_strips_idx_ptr + first * 2, (*count - 1) * 2 * sizeof(uint16_t));
+		ptr[(*count - 1) * 2] = first + *count - 1;
+		ptr[(*count - 1) * 2 + 1] = first;
+
+		*count *= 2;
+		break;
+	default:
+		ptr = default_idx_ptr + first;
+		break;
+	}
+	return ptr;
+}
+
+static void *get_elements_indices(gpubuffer *gpu_buf, void *src, GLenum mode, GLenum type, uint32_t offset, GLsizei *count) {
+	void *ptr = NULL;
+	// Directly use the current IBO if there is no need for a temporary index buffer.
+	if (gpu_buf != NULL && !prim_is_non_native && type != GL_UNSIGNED_BYTE) {
+		ptr = src;
+		gpu_buf->used = GL_TRUE;
+	} else if (gpu_buf != NULL) {
+		// Reusing converted indices from previous draws with the same IBO range
+		ptr = get_cached_indices(gpu_buf, mode, type, offset, *count);
+	}
+
+	// Falling back to a temporary index buffer
+	if (!ptr) {
+		ptr = gpu_alloc_mapped_temp(get_converted_idx_count(mode, *count) * gxm_idx_size(type));
+		convert_indices(ptr, src, mode, type, *count);
+	}
+	*count = get_converted_idx_count(mode, *count);
+	return ptr;
+}
+
+void glDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei primcount) {
+#ifndef SKIP_ERROR_HANDLING
+	if (!is_prim_mode_legal(mode)) {
+		SET_GL_ERROR(GL_INVALID_ENUM)
+	} else if (primcount < 0) {
+		SET_GL_ERROR(GL_INVALID_VALUE)
+	}
+#endif
+	if (!primcount)
+		return;
+
+	// Skipping draws without vertices before a scene gets started for them
+	if (cur_program == 0 && !(ffp_vertex_attrib_state & (1 << 0)))
+		return;
+
 	SceGxmPrimitiveType gxm_p;
 	gl_primitive_to_gxm(mode, gxm_p, count);
 	sceneReset();
 	GLboolean is_draw_legal = GL_TRUE;
 
-	if (cur_program != 0)
-		is_draw_legal = _glDrawArrays_CustomShadersIMPL(first + count);
-	else {
-		if (!(ffp_vertex_attrib_state & (1 << 0)))
+	if (cur_program != 0) {
+		flush_pending_draws();
+		is_draw_legal = _glDrawArrays_CustomShadersIMPL(first + count, primcount);
+	} else {
+		flush_legacy_draw();
+#ifdef HAVE_DRAW_BATCHING
+		// Merging the draw call with the pending batched one if possible
+		if (primcount == 1 && _glDrawArrays_BatchedIMPL(mode, first, count))
 			return;
+		flush_draw_batch();
+#endif
 		_glDrawArrays_FixedFunctionIMPL(first + count);
 	}
 
@@ -983,112 +1561,220 @@ void glDrawArrays(GLenum mode, GLint first, GLsizei count) {
 	if (is_draw_legal)
 #endif
 	{
-		uint16_t *ptr;
-		switch (mode) {
-		case GL_QUADS:
-			ptr = default_quads_idx_ptr + (first / 2) * 3;
-			count = (count / 2) * 3;
-			break;
-		case GL_LINE_STRIP:
-			ptr = default_line_strips_idx_ptr + first * 2;
-			count = (count - 1) * 2;
-			break;
-		case GL_LINE_LOOP:
-			ptr = gpu_alloc_mapped_temp(count * 2 * sizeof(uint16_t));
-			sceClibMemcpy(ptr, default_line_strips_idx_ptr + first * 2, (count - 1) * 2 * sizeof(uint16_t));
-			ptr[(count - 1) * 2] = first + count - 1;
-			ptr[(count - 1) * 2 + 1] = first;
-
-			count *= 2;
-			break;
-		default:
-			ptr = default_idx_ptr + first;
-			break;
-		}
+		uint16_t *ptr = get_arrays_indices(mode, first, &count);
 
-		sceGxmDraw(gxm_context, gxm_p, SCE_GXM_INDEX_FORMAT_U16, ptr, count);
+		vglFlushGxmState();
+		if (primcount == 1)
+			sceGxmDraw(gxm_context, gxm_p, SCE_GXM_INDEX_FORMAT_U16, ptr, count);
+		else
+			sceGxmDrawInstanced(gxm_context, gxm_p, SCE_GXM_INDEX_FORMAT_U16, ptr, count * primcount, count);
 	}
 	restore_polygon_mode(gxm_p);
 }
 
-void glDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid *gl_indices) {
+void glDrawArrays(GLenum mode, GLint first, GLsizei count) {
+	glDrawArraysInstanced(mode, first, count, 1);
+}
+
+void glDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const GLvoid *gl_indices, GLsizei primcount) {
 #ifndef SKIP_ERROR_HANDLING
-	if (type != GL_UNSIGNED_SHORT) {
+	if (!is_prim_mode_legal(mode) || (type != GL_UNSIGNED_SHORT && type != GL_UNSIGNED_INT && type != GL_UNSIGNED_BYTE)) {
 		SET_GL_ERROR(GL_INVALID_ENUM)
 	} else if (phase == MODEL_CREATION) {
 		SET_GL_ERROR(GL_INVALID_OPERATION)
-	} else if (count < 0) {
+	} else if (count < 0 || primcount < 0) {
 		SET_GL_ERROR(GL_INVALID_VALUE)
 	}
 #endif
+	if (!primcount)
+		return;
+
+	// Skipping draws without vertices before a scene gets started for them
+	if (cur_program == 0 && !(ffp_vertex_attrib_state & (1 << 0)))
+		return;
 
 	SceGxmPrimitiveType gxm_p;
 	gl_primitive_to_gxm(mode, gxm_p, count);
 	sceneReset();
+	flush_pending_draws();
 	GLboolean is_draw_legal = GL_TRUE;
 
 	gpubuffer *gpu_buf = (gpubuffer *)index_array_unit;
-	uint16_t *src = gpu_buf ? (uint16_t *)((uint8_t *)gpu_buf->ptr + (uint32_t)gl_indices) : (uint16_t *)gl_indices;
+	void *src = gpu_buf ? (uint8_t *)gpu_buf->ptr + (uint32_t)gl_indices : (void *)gl_indices;
 	if (cur_program != 0)
-		is_draw_legal = _glDrawElements_CustomShadersIMPL(src, count);
-	else {
-		if (!(ffp_vertex_attrib_state & (1 << 0)))
-			return;
-		_glDrawElements_FixedFunctionIMPL(src, count);
+		is_draw_legal = _glDrawElements_CustomShadersIMPL(src, type, count, primcount, NULL);
+	else
+		_glDrawElements_FixedFunctionIMPL(src, type, count, NULL);
+
+#ifndef SKIP_ERROR_HANDLING
+	if (is_draw_legal)
+#endif
+	{
+		void *ptr = get_elements_indices(gpu_buf, src, mode, type, (uint32_t)gl_indices, &count);
+
+		vglFlushGxmState();
+		if (primcount == 1)
+			sceGxmDraw(gxm_context, gxm_p, type == GL_UNSIGNED_INT ? SCE_GXM_INDEX_FORMAT_U32 : SCE_GXM_INDEX_FORMAT_U16, ptr, count);
+		else
+			sceGxmDrawInstanced(gxm_context, gxm_p, type == GL_UNSIGNED_INT ? SCE_GXM_INDEX_FORMAT_U32 : SCE_GXM_INDEX_FORMAT_U16, ptr, count * primcount, count);
 	}
 
+	restore_polygon_mode(gxm_p);
+}
+
+void glDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid *gl_indices) {
+	glDrawElementsInstanced(mode, count, type, gl_indices, 1);
+}
+
+void glMultiDrawArrays(GLenum mode, const GLint *first, const GLsizei *count, GLsizei drawcount) {
+#ifndef SKIP_ERROR_HANDLING
+	if (!is_prim_mode_legal(mode)) {
+		SET_GL_ERROR(GL_INVALID_ENUM)
+	} else if (drawcount < 0) {
+		SET_GL_ERROR(GL_INVALID_VALUE)
+	}
+#endif
+
+	// Detecting the vertex range used by the whole set of draws
+	GLsizei i, total = 0;
+	GLint last = 0;
+	for (i = 0; i < drawcount; i++) {
+		if (is_prim_count_legal(mode, count[i])) {
+			total += count[i];
+			if (first[i] + count[i] > last)
+				last = first[i] + count[i];
+		}
+	}
+
+	// Skipping draws without vertices before a scene gets started for them
+	if (!total || (cur_program == 0 && !(ffp_vertex_attrib_state & (1 << 0))))
+		return;
+
+	SceGxmPrimitiveType gxm_p;
+	gl_primitive_to_gxm(mode, gxm_p, total);
+	sceneReset();
+	flush_pending_draws();
+	GLboolean is_draw_legal = GL_TRUE;
+
+	// Validating and binding draw state once for all the sub-ranges
+	if (cur_program != 0)
+		is_draw_legal = _glDrawArrays_CustomShadersIMPL(last, 1);
+	else
+		_glDrawArrays_FixedFunctionIMPL(last);
+
 #ifndef SKIP_ERROR_HANDLING
 	if (is_draw_legal)
 #endif
 	{
-		uint16_t *ptr;
-		// Directly use the current IBO if there is no need for a temporary index buffer.
-		if (gpu_buf != NULL && !prim_is_non_native) {
-			ptr = (uint16_t *)((uint8_t *)gpu_buf->ptr + (uint32_t)gl_indices);
-			gpu_buf->used = GL_TRUE;
-		} else {
-			int i;
-			switch (mode) {
-			case GL_QUADS:
-				ptr = gpu_alloc_mapped_temp(count * 3 * sizeof(uint16_t));
-				for (i = 0; i < count / 4; i++) {
-					ptr[i * 6] = src[i * 4];
-					ptr[i * 6 + 1] = src[i * 4 + 1];
-					ptr[i * 6 + 2] = src[i * 4 + 3];
-					ptr[i * 6 + 3] = src[i * 4 + 1];
-					ptr[i * 6 + 4] = src[i * 4 + 2];
-					ptr[i * 6 + 5] = src[i * 4 + 3];
+		vglFlushGxmState();
+		for (i = 0; i < drawcount; i++) {
+			if (!is_prim_count_legal(mode, count[i]))
+				continue;
+
+			// Coalescing contiguous sub-ranges into a single draw
+			GLint start = first[i];
+			GLsizei cnt = count[i];
+			if (is_prim_list(mode)) {
+				while (i + 1 < drawcount && first[i + 1] == start + cnt && is_prim_count_legal(mode, count[i + 1])) {
+					cnt += count[++i];
 				}
-				count = (count / 2) * 3;
-				break;
-			case GL_LINE_STRIP:
-				ptr = gpu_alloc_mapped_temp((count - 1) * 2 * sizeof(uint16_t));
-				for (i = 0; i < count - 1; i++) {
-					ptr[i * 2] = src[i];
-					ptr[i * 2 + 1] = src[i + 1];
-				}
-				count = (count - 1) * 2;
-				break;
-			case GL_LINE_LOOP:
-				ptr = gpu_alloc_mapped_temp(count * 2 * sizeof(uint16_t));
-				for (i = 0; i < count - 1; i++) {
-					ptr[i * 2] = src[i];
-					ptr[i * 2 + 1] = src[i + 1];
-				}
-				ptr[i * 2] = src[count - 1];
-				ptr[i * 2 + 1] = src[0];
-				count = count * 2;
-				break;
-			default:
-				ptr = gpu_alloc_mapped_temp(count * sizeof(uint16_t));
-				sceClibMemcpy(ptr, src, count * sizeof(uint16_t));
-				break;
 			}
+
+			uint16_t *ptr = get_arrays_indices(mode, start, &cnt);
+			sceGxmDraw(gxm_context, gxm_p, SCE_GXM_INDEX_FORMAT_U16, ptr, cnt);
 		}
+	}
+	restore_polygon_mode(gxm_p);
+}
+
+void glMultiDrawElements(GLenum mode, const GLsizei *count, GLenum type, const GLvoid *const *indices, GLsizei drawcount) {
+#ifndef SKIP_ERROR_HANDLING
+	if (!is_prim_mode_legal(mode) || (type != GL_UNSIGNED_SHORT && type != GL_UNSIGNED_INT && type != GL_UNSIGNED_BYTE)) {
+		SET_GL_ERROR(GL_INVALID_ENUM)
+	} else if (phase == MODEL_CREATION) {
+		SET_GL_ERROR(GL_INVALID_OPERATION)
+	} else if (drawcount < 0) {
+		SET_GL_ERROR(GL_INVALID_VALUE)
+	}
+	for (GLsizei j = 0; j < drawcount; j++) {
+		if (count[j] < 0) {
+			SET_GL_ERROR(GL_INVALID_VALUE)
+		}
+	}
+#endif
 
-		sceGxmDraw(gxm_context, gxm_p, SCE_GXM_INDEX_FORMAT_U16, ptr, count);
+	// Client side index arrays can live anywhere in memory, so they are drawn one by one
+	GLsizei i;
+	gpubuffer *gpu_buf = (gpubuffer *)index_array_unit;
+	if (!gpu_buf) {
+		for (i = 0; i < drawcount; i++) {
+			glDrawElements(mode, count[i], type, indices[i]);
+		}
+		return;
 	}
 
+	// Detecting the IBO span and the index values range used by the whole set of draws
+	uint32_t idx_size = gl_idx_size(type);
+	uint32_t start = 0xFFFFFFFF, end = 0;
+	uint32_t idx_range[2] = {0xFFFFFFFF, 0};
+	GLsizei total = 0;
+	for (i = 0; i < drawcount; i++) {
+		if (is_prim_count_legal(mode, count[i])) {
+			uint32_t offset = (uint32_t)indices[i];
+			uint32_t sub_min, sub_max;
+			total += count[i];
+			if (offset < start)
+				start = offset;
+			if (offset + count[i] * idx_size > end)
+				end = offset + count[i] * idx_size;
+			get_index_range((uint8_t *)gpu_buf->ptr + offset, type, count[i], &sub_min, &sub_max);
+			if (sub_min < idx_range[0])
+				idx_range[0] = sub_min;
+			if (sub_max > idx_range[1])
+				idx_range[1] = sub_max;
+		}
+	}
+
+	// Skipping draws without vertices before a scene gets started for them
+	if (!total || (cur_program == 0 && !(ffp_vertex_attrib_state & (1 << 0))))
+		return;
+
+	SceGxmPrimitiveType gxm_p;
+	gl_primitive_to_gxm(mode, gxm_p, total);
+	sceneReset();
+	flush_pending_draws();
+	GLboolean is_draw_legal = GL_TRUE;
+
+	// Validating and binding draw state once for all the sub-ranges
+	void *src = (uint8_t *)gpu_buf->ptr + start;
+	if (cur_program != 0)
+		is_draw_legal = _glDrawElements_CustomShadersIMPL(src, type, (end - start) / idx_size, 1, idx_range);
+	else
+		_glDrawElements_FixedFunctionIMPL(src, type, (end - start) / idx_size, idx_range);
+
+#ifndef SKIP_ERROR_HANDLING
+	if (is_draw_legal)
+#endif
+	{
+		vglFlushGxmState();
+		GLboolean can_merge = is_prim_list(mode) && !prim_is_non_native && type != GL_UNSIGNED_BYTE;
+		for (i = 0; i < drawcount; i++) {
+			if (!is_prim_count_legal(mode, count[i]))
+				continue;
+
+			// Coalescing contiguous sub-ranges into a single draw
+			uint32_t offset = (uint32_t)indices[i];
+			GLsizei cnt = count[i];
+			if (can_merge) {
+				while (i + 1 < drawcount && (uint32_t)indices[i + 1] == offset + cnt * idx_size && is_prim_count_legal(mode, count[i + 1])) {
+					cnt += count[++i];
+				}
+			}
+
+			void *ptr = get_elements_indices(gpu_buf, (uint8_t *)gpu_buf->ptr + offset, mode, type, offset, &cnt);
+			sceGxmDraw(gxm_context, gxm_p, type == GL_UNSIGNED_INT ? SCE_GXM_INDEX_FORMAT_U32 : SCE_GXM_INDEX_FORMAT_U16, ptr, cnt);
+		}
+	}
 	restore_polygon_mode(gxm_p);
 }
 
@@ -1289,20 +1975,28 @@ void vglIndexPointerMapped(const GLvoid *pointer) {
 
 void vglDrawObjects(GLenum mode, GLsizei count, GLboolean implicit_wvp) {
 #ifndef SKIP_ERROR_HANDLING
-	if (phase == MODEL_CREATION) {
+	if (!is_prim_mode_legal(mode)) {
+		SET_GL_ERROR(GL_INVALID_ENUM)
+	} else if (phase == MODEL_CREATION) {
 		SET_GL_ERROR(GL_INVALID_OPERATION)
 	} else if (count < 0) {
 		SET_GL_ERROR(GL_INVALID_VALUE)
 	}
 #endif
 
+	// Skipping draws without vertices before a scene gets started for them
+	if (!count || (cur_program == 0 && !(ffp_vertex_attrib_state & (1 << 0))))
+		return;
+
 	SceGxmPrimitiveType gxm_p;
 	gl_primitive_to_gxm(mode, gxm_p, count);
 	sceneReset();
+	flush_pending_draws();
 
 	texture_unit *tex_unit = &texture_units[0];
 	if (cur_program != 0) {
 		_vglDrawObjects_CustomShadersIMPL(implicit_wvp);
+		vglFlushGxmState();
 		sceGxmDraw(gxm_context, gxm_p, SCE_GXM_INDEX_FORMAT_U16, index_object, count);
 	} else if (ffp_vertex_attrib_state & (1 << 0)) {
 		reload_ffp_shaders(NULL, NULL);
@@ -1316,6 +2010,7 @@ void vglDrawObjects(GLenum mode, GLsizei count, GLboolean implicit_wvp) {
 		} else if (ffp_vertex_num_params > 1)
 			sceGxmSetVertexStream(gxm_context, 1, color_object);
 		sceGxmSetVertexStream(gxm_context, 0, vertex_object);
+		vglFlushGxmState();
 		sceGxmDraw(gxm_context, gxm_p, SCE_GXM_INDEX_FORMAT_U16, index_object, count);
 	}
 
@@ -1359,3 +2054,34 @@ void vglSetVertexPoolSize(uint32_t size) {
 	vertex_data_pool_size = size;
 #endif
 }
+
+void vglGetStaticArraysCacheStats(uint32_t *hits, uint32_t *misses, uint32_t *promotions, uint32_t *evictions) {
+#ifdef HAVE_STATIC_ARRAYS_CACHE
+	if (hits)
+		*hits = static_arrays_hits;
+	if (misses)
+		*misses = static_arrays_misses;
+	if (promotions)
+		*promotions = static_arrays_promotions;
+	if (evictions)
+		*evictions = static_arrays_evictions;
+#else
+	if (hits)
+		*hits = 0;
+	if (misses)
+		*misses = 0;
+	if (promotions)
+		*promotions = 0;
+	if (evictions)
+		*evictions = 0;
+#endif
+}
+
+void vglResetStaticArraysCacheStats(void) {
+#ifdef HAVE_STATIC_ARRAYS_CACHE
+	static_arrays_hits = 0;
+	static_arrays_misses = 0;
+	static_arrays_promotions = 0;
+	static_arrays_evictions = 0;
+#endif
+}
@@ -72,6 +72,8 @@ extern "C" {
 
 #define GL_NONE                               0
 
+#define GL_INVALID_INDEX                      0xFFFFFFFFu
+
 #define GL_POINTS                                    0x0000
 #define GL_LINES                                     0x0001
 #define GL_LINE_LOOP                                 0x0002
@@ -155,6 +157,7 @@ extern "C" {
 #define GL_SHORT                                     0x1402
 #define GL_UNSIGNED_SHORT                            0x1403
 #define GL_INT                                       0x1404
+#define GL_UNSIGNED_INT                              0x1405
 #define GL_FLOAT                                     0x1406
 #define GL_HALF_FLOAT                                0x140B
 #define GL_FIXED                                     0x140C
@@ -317,8 +320,15 @@ extern "C" {
 #define GL_VERTEX_ATTRIB_ARRAY_POINTER               0x8645
 #define GL_NUM_COMPRESSED_TEXTURE_FORMATS            0x86A2
 #define GL_COMPRESSED_TEXTURE_FORMATS                0x86A3
+#define GL_PROGRAM_BINARY_LENGTH                     0x8741
 #define GL_MIRROR_CLAMP_EXT                          0x8742
 #define GL_BUFFER_SIZE                               0x8764
+#define GL_NUM_PROGRAM_BINARY_FORMATS                0x87FE
+#define GL_PROGRAM_BINARY_FORMATS                    0x87FF
+#define GL_QUERY_COUNTER_BITS                        0x8864
+#define GL_CURRENT_QUERY                             0x8865
+#define GL_QUERY_RESULT                              0x8866
+#define GL_QUERY_RESULT_AVAILABLE                    0x8867
 #define GL_MAX_VERTEX_ATTRIBS                        0x8869
 #define GL_VERTEX_ATTRIB_ARRAY_NORMALIZED            0x886A
 #define GL_MAX_TEXTURE_COORDS                        0x8871
@@ -326,6 +336,8 @@ extern "C" {
 #define GL_ARRAY_BUFFER                              0x8892
 #define GL_ELEMENT_ARRAY_BUFFER                      0x8893
 #define GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING        0x889F
+#define GL_TIME_ELAPSED                              0x88BF
+#define GL_VERTEX_ATTRIB_ARRAY_DIVISOR               0x88FE
 #define GL_STREAM_DRAW                               0x88E0
 #define GL_STREAM_READ                               0x88E1
 #define GL_STREAM_COPY                               0x88E2
@@ -335,6 +347,9 @@ extern "C" {
 #define GL_DYNAMIC_DRAW                              0x88E8
 #define GL_DYNAMIC_READ                              0x88E9
 #define GL_DYNAMIC_COPY                              0x88EA
+#define GL_UNIFORM_BUFFER                            0x8A11
+#define GL_UNIFORM_BUFFER_BINDING                    0x8A28
+#define GL_MAX_UNIFORM_BUFFER_BINDINGS               0x8A2F
 #define GL_FRAGMENT_SHADER                           0x8B30
 #define GL_VERTEX_SHADER                             0x8B31
 #define GL_SHADER_TYPE                               0x8B4F
@@ -393,8 +408,10 @@ extern "C" {
 #define GL_MAX_VERTEX_UNIFORM_VECTORS                0x8DFB
 #define GL_MAX_VARYING_VECTORS                       0x8DFC
 #define GL_MAX_FRAGMENT_UNIFORM_VECTORS              0x8DFD
+#define GL_TIMESTAMP                                 0x8E28
 #define GL_COMPRESSED_RGBA_PVRTC_2BPPV2_IMG          0x9137
 #define GL_COMPRESSED_RGBA_PVRTC_4BPPV2_IMG          0x9138
+#define GL_SGX_PROGRAM_BINARY_IMG                    0x9130
 
 #define EGL_SUCCESS                                  0x3000
 #define EGL_BAD_PARAMETER                            0x300C
@@ -418,8 +435,11 @@ void glActiveTexture(GLenum texture);
 void glAlphaFunc(GLenum func, GLfloat ref);
 void glAttachShader(GLuint prog, GLuint shad);
 void glBegin(GLenum mode);
+void glBeginQuery(GLenum target, GLuint id);
 void glBindAttribLocation(GLuint program, GLuint index, const GLchar *name);
 void glBindBuffer(GLenum target, GLuint buffer);
+void glBindBufferBase(GLenum target, GLuint index, GLuint buffer);
+void glBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
 void glBindFramebuffer(GLenum target, GLuint framebuffer);
 void glBindRenderbuffer(GLenum target, GLuint renderbuffer);
 void glBindTexture(GLenum target, GLuint texture);
@@ -427,6 +447,7 @@ void glBlendEquation(GLenum mode);
 void glBlendEquationSeparate(GLenum modeRGB, GLenum modeAlpha);
 void glBlendFunc(GLenum sfactor, GLenum dfactor);
 void glBlendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha);
+void glBlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter); // Only 1:1 copies and 2x downscales of color attachments are supported
 void glBufferData(GLenum target, GLsizei size, const GLvoid *data, GLenum usage);
 void glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data);
 GLenum glCheckFramebufferStatus(GLenum target);
@@ -451,12 +472,15 @@ void glColorPointer(GLint size, GLenum type, GLsizei stride, const GLvoid *point
 void glColorTable(GLenum target, GLenum internalformat, GLsizei width, GLenum format, GLenum type, const GLvoid *data);
 void glCompileShader(GLuint shader);
 void glCompressedTexImage2D(GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const void *data); // Mipmap levels are ignored currently
+void glCopyTexImage2D(GLenum target, GLint level, GLenum internalformat, GLint x, GLint y, GLsizei width, GLsizei height, GLint border);
+void glCopyTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint x, GLint y, GLsizei width, GLsizei height);
 GLuint glCreateProgram(void);
 GLuint glCreateShader(GLenum shaderType);
 void glCullFace(GLenum mode);
 void glDeleteBuffers(GLsizei n, const GLuint *gl_buffers);
 void glDeleteFramebuffers(GLsizei n, const GLuint *framebuffers);
 void glDeleteProgram(GLuint prog);
+void glDeleteQueries(GLsizei n, const GLuint *ids);
 void glDeleteRenderbuffers(GLsizei n, const GLuint *renderbuffers);
 void glDeleteShader(GLuint shad);
 void glDeleteTextures(GLsizei n, const GLuint *textures);
@@ -468,11 +492,14 @@ void glDisable(GLenum cap);
 void glDisableClientState(GLenum array);
 void glDisableVertexAttribArray(GLuint index);
 void glDrawArrays(GLenum mode, GLint first, GLsizei count);
+void glDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei primcount);
 void glDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid *indices);
+void glDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const GLvoid *indices, GLsizei primcount);
 void glEnable(GLenum cap);
 void glEnableClientState(GLenum array);
 void glEnableVertexAttribArray(GLuint index);
 void glEnd(void);
+void glEndQuery(GLenum target);
 void glFinish(void);
 void glFlush(void);
 void glFogf(GLenum pname, GLfloat param);
@@ -486,6 +513,7 @@ void glFrustum(GLdouble left, GLdouble right, GLdouble bottom, GLdouble top, GLd
 void glGenBuffers(GLsizei n, GLuint *buffers);
 void glGenerateMipmap(GLenum target);
 void glGenFramebuffers(GLsizei n, GLuint *framebuffers);
+void glGenQueries(GLsizei n, GLuint *ids);
 void glGenRenderbuffers(GLsizei n, GLuint *renderbuffers);
 void glGenTextures(GLsizei n, GLuint *textures);
 void glGetActiveAttrib(GLuint prog, GLuint index, GLsizei bufSize, GLsizei *length, GLint *size, GLenum *type, GLchar *name);
@@ -496,12 +524,19 @@ void glGetBufferParameteriv(GLenum target, GLenum pname, GLint *params);
 void glGetFloatv(GLenum pname, GLfloat *data);
 GLenum glGetError(void);
 void glGetIntegerv(GLenum pname, GLint *data);
+void glGetProgramBinary(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary);
 void glGetProgramInfoLog(GLuint program, GLsizei maxLength, GLsizei *length, GLchar *infoLog);
 void glGetProgramiv(GLuint program, GLenum pname, GLint *params);
+void glGetQueryObjecti64v(GLuint id, GLenum pname, GLint64 *params);
+void glGetQueryObjectiv(GLuint id, GLenum pname, GLint *params);
+void glGetQueryObjectui64v(GLuint id, GLenum pname, GLuint64 *params);
+void glGetQueryObjectuiv(GLuint id, GLenum pname, GLuint *params);
+void glGetQueryiv(GLenum target, GLenum pname, GLint *params);
 void glGetShaderInfoLog(GLuint handle, GLsizei maxLength, GLsizei *length, GLchar *infoLog);
 void glGetShaderiv(GLuint handle, GLenum pname, GLint *params);
 const GLubyte *glGetString(GLenum name);
 const GLubyte *glGetStringi(GLenum name, GLuint index);
+GLuint glGetUniformBlockIndex(GLuint prog, const GLchar *name);
 GLint glGetUniformLocation(GLuint prog, const GLchar *name);
 void glGetVertexAttribfv(GLuint index, GLenum pname, GLfloat *params);
 void glGetVertexAttribiv(GLuint index, GLenum pname, GLint *params);
@@ -510,6 +545,7 @@ void glHint(GLenum target, GLenum mode);
 void glInterleavedArrays(GLenum format, GLsizei stride, const void *pointer);
 GLboolean glIsEnabled(GLenum cap);
 GLboolean glIsFramebuffer(GLuint fb);
+GLboolean glIsQuery(GLuint id);
 GLboolean glIsTexture(GLuint texture);
 void glLightfv(GLenum light, GLenum pname, const GLfloat *params);
 void glLineWidth(GLfloat width);
@@ -519,6 +555,8 @@ void glLoadMatrixf(const GLfloat *m);
 void glMaterialfv(GLenum face, GLenum pname, const GLfloat *params);
 void glMatrixMode(GLenum mode);
 void glMultMatrixf(const GLfloat *m);
+void glMultiDrawArrays(GLenum mode, const GLint *first, const GLsizei *count, GLsizei drawcount);
+void glMultiDrawElements(GLenum mode, const GLsizei *count, GLenum type, const GLvoid *const *indices, GLsizei drawcount);
 void glNormal3f(GLfloat x, GLfloat y, GLfloat z);
 void glNormal3fv(const GLfloat *v);
 void glOrtho(GLdouble left, GLdouble right, GLdouble bottom, GLdouble top, GLdouble nearVal, GLdouble farVal);
@@ -526,7 +564,9 @@ void glPointSize(GLfloat size);
 void glPolygonMode(GLenum face, GLenum mode);
 void glPolygonOffset(GLfloat factor, GLfloat units);
 void glPopMatrix(void);
+void glProgramBinary(GLuint program, GLenum binaryFormat, const void *binary, GLsizei length);
 void glPushMatrix(void);
+void glQueryCounter(GLuint id, GLenum target);
 void glReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, GLvoid *data);
 void glReleaseShaderCompiler(void);
 void glRenderbufferStorage(GLenum target, GLenum internalformat, GLsizei width, GLsizei height);
@@ -569,6 +609,7 @@ void glUniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3)
 void glUniform4fv(GLint location, GLsizei count, const GLfloat *value);
 void glUniform4i(GLint location, GLint v0, GLint v1, GLint v2, GLint v3);
 void glUniform4iv(GLint location, GLsizei count, const GLint *value);
+void glUniformBlockBinding(GLuint prog, GLuint uniformBlockIndex, GLuint uniformBlockBinding);
 void glUniformMatrix2fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value);
 void glUniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value);
 void glUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value);
@@ -584,6 +625,7 @@ void glVertexAttrib3f(GLuint index, GLfloat v0, GLfloat v1, GLfloat v2);
 void glVertexAttrib3fv(GLuint index, const GLfloat *v);
 void glVertexAttrib4f(GLuint index, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3);
 void glVertexAttrib4fv(GLuint index, const GLfloat *v);
+void glVertexAttribDivisor(GLuint index, GLuint divisor);
 void glVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void *pointer);
 void glVertexPointer(GLint size, GLenum type, GLsizei stride, const GLvoid *pointer);
 void glViewport(GLint x, GLint y, GLsizei width, GLsizei height);
@@ -624,6 +666,12 @@ typedef enum {
 	VGL_MEM_ALL
 } vglMemType;
 
+typedef enum {
+	VGL_PACING_NONE, // Presentation follows VSync setting
+	VGL_PACING_STABLE, // Presentation is held to a stable interval picked from measured frame times
+	VGL_PACING_MAILBOX // Like VGL_PACING_STABLE but queued frames are presented right away if newer ones are ready
+} vglFramePacingMode;
+
 // vgl*
 void *vglAlloc(uint32_t size, vglMemType type);
 void vglEnableRuntimeShaderCompiler(GLboolean usage);
@@ -631,7 +679,13 @@ void vglEnd(void);
 void *vglForceAlloc(uint32_t size);
 void vglFree(void *addr);
 SceGxmTexture *vglGetGxmTexture(GLenum target);
+float vglGetDynamicResolutionScale(void);
+void vglGetFramePacingStats(uint32_t *cpu_time, uint32_t *gpu_time, uint32_t *present_vblanks, uint32_t *target_vblanks, uint32_t *missed);
+void vglGetGxmStateStats(uint32_t *issued, uint32_t *elided);
+void vglGetLegacyPoolStats(uint32_t *peak_usage, uint32_t *extra_chunks);
 void *vglGetProcAddress(const char *name);
+void vglGetSceneStats(uint32_t *last_frame, uint32_t *peak);
+void vglGetStaticArraysCacheStats(uint32_t *hits, uint32_t *misses, uint32_t *promotions, uint32_t *evictions);
 void *vglGetTexDataPointer(GLenum target);
 GLboolean vglHasRuntimeShaderCompiler(void);
 void vglInit(int legacy_pool_size);
@@ -639,7 +693,15 @@ void vglInitExtended(int legacy_pool_size, int width, int height, int ram_thresh
 void vglInitWithCustomSizes(int legacy_pool_size, int width, int height, int ram_pool_size, int cdram_pool_size, int phycont_pool_size, SceGxmMultisampleMode msaa);
 void vglInitWithCustomThreshold(int pool_size, int width, int height, int ram_threshold, int cdram_threshold, int phycont_threshold, SceGxmMultisampleMode msaa);
 size_t vglMemFree(vglMemType type);
+void vglRenderbufferStorageTransient(GLenum target, GLenum internalformat, GLsizei width, GLsizei height);
+void vglResetFramePacingStats(void);
+void vglResetGxmStateStats(void);
+void vglResetLegacyPoolStats(void);
+void vglResetSceneStats(void);
+void vglResetStaticArraysCacheStats(void);
+void vglSetDynamicResolution(GLboolean enable, float min_scale, float max_scale, uint32_t target_frame_time);
 void vglSetFragmentBufferSize(uint32_t size);
+void vglSetFramePacing(vglFramePacingMode mode, uint32_t max_interval);
 void vglSetParamBufferSize(uint32_t size);
 void vglSetUSSEBufferSize(uint32_t size);
 void vglSetVDMBufferSize(uint32_t size);